@@ -1,42 +1,101 @@
 
 #include "bigint.h"
+#include "bigint_stats.h"
+#include "bigint_mpn.h"
 #include <cassert>
-#include <sstream>
-#include <iomanip>
+#include <ostream>
 #include <ios>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <stdexcept>
+
+#ifdef BIGINT_TUNE
+size_t BigInt::KARATSUBA_THRESHOLD = BIGINT_KARATSUBA_THRESHOLD;
+size_t BigInt::PARALLEL_MUL_THRESHOLD = BIGINT_PARALLEL_MUL_THRESHOLD;
+size_t BigInt::TO_STRING_DC_THRESHOLD = BIGINT_TO_STRING_DC_THRESHOLD;
+size_t BigInt::FROM_STRING_DC_THRESHOLD = BIGINT_FROM_STRING_DC_THRESHOLD;
+#endif
+
+// Storage for zero, shared by all default-constructed values
+static const std::shared_ptr<std::vector<uint64_t>> &zero_storage() {
+    static const std::shared_ptr<std::vector<uint64_t>> zero =
+        std::make_shared<std::vector<uint64_t>>(1, 0);
+    return zero;
+}
 
 // Default constructor for BigInt, initializes to 0 
-BigInt::BigInt() : bits(1, 0), negative(false) {}
+BigInt::BigInt() : bits(zero_storage()), len(0), negative(false) {
+}
 
 // Constructor from initializer list, initializes BigInt with specified bits and sign
 BigInt::BigInt(const std::initializer_list<uint64_t> vals, bool negative)
-    : bits(vals), negative(negative) {
+    : bits(std::make_shared<std::vector<uint64_t>>(vals)), negative(negative) {
 
-    while (bits.size() > 1 && bits.back() == 0) {
-        bits.pop_back();  // Remove the most significant zeroes
+    BIGINT_NOTE_ALLOC(bits->size() * sizeof(uint64_t));
+    if (bits->empty()) {
+        bits->push_back(0);
     }
+    len = mpn_normalized_size(bits->data(), bits->size());  // Skip the most significant zeroes
+    bits->resize(std::max<size_t>(len, 1));
 }
 
 // Constructor from a single 64-bit unsigned integer, initializes BigInt with the given value and sign
 BigInt::BigInt(uint64_t val, bool negative)
-    : bits(1, val), negative(negative) {}
+    : bits(std::make_shared<std::vector<uint64_t>>(1, val)), len(val != 0), negative(negative) {
+    BIGINT_NOTE_ALLOC(sizeof(uint64_t));
+}
+
+// Constructor from a computed magnitude, trimming its leading zeroes
+// (shrinking keeps the capacity, so it never reallocates)
+BigInt::BigInt(std::vector<uint64_t> &&magnitude, bool negative) {
+    // The magnitude vector was freshly allocated by the caller
+    BIGINT_NOTE_ALLOC(magnitude.size() * sizeof(uint64_t));
+    if (magnitude.empty()) {
+        magnitude.push_back(0);
+    }
+    len = mpn_normalized_size(magnitude.data(), magnitude.size());
+    magnitude.resize(std::max<size_t>(len, 1));
+    this->negative = negative && len > 0;
+    bits = std::make_shared<std::vector<uint64_t>>(std::move(magnitude));
+}
 
-// Deep copy of bits and sign
+// Copy of the sign; the bits are shared until one side is modified
 BigInt::BigInt(const BigInt &other)
-    : bits(other.bits), negative(other.negative) {}
+    : bits(other.bits), len(other.len), negative(other.negative) {
+    BIGINT_OP_SCOPE(BigIntOp::COPY, other.len);
+}
 
 // Destructor
 BigInt::~BigInt() {}
 
-// Assignment operator, assigns the values of another BigInt to this BigInt
+// Assignment operator, shares the bits of another BigInt and copies its sign
 BigInt &BigInt::operator=(const BigInt &rhs) {
     if (this != &rhs) {
-        bits = rhs.bits;       // Copy the bit vector
+        BIGINT_OP_SCOPE(BigIntOp::COPY, rhs.len);
+        bits = rhs.bits;         // Share the bit vector
+        len = rhs.len;
         negative = rhs.negative; // Copy the sign
     }
     return *this;
 }
 
+std::vector<uint64_t> &BigInt::mutable_bits() {
+    // A count of 1 means no other value can start sharing concurrently
+    // (that would need a reference to this object), so the check is safe
+    // (The copy leaves out any leading zero limbs)
+    if (bits.use_count() != 1) {
+        size_t n = std::max<size_t>(len, 1);
+        BIGINT_NOTE_ALLOC(n * sizeof(uint64_t));
+        bits = std::make_shared<std::vector<uint64_t>>(bits->begin(), bits->begin() + n);
+    }
+    return *bits;
+}
+
 // Returns true if the BigInt is negative and false otherwise
 bool BigInt::is_negative() const {
     return negative;
@@ -45,55 +104,40 @@ bool BigInt::is_negative() const {
 // Returns the 64-bit chunk at the specified index in the bit vector.
 // If the index is out of bounds, it returns 0 
 uint64_t BigInt::get_bits(unsigned index) const {
-    if (index < bits.size()) {
-        return bits[index];  // Return the bits at the specified index
+    if (index < len) {
+        return (*bits)[index];  // Return the bits at the specified index
     }
     return 0;  // Return 0 if index is out of bounds
 }
 
 // Returns a const reference to the bit vector, which stores the magnitude of the BigInt
+// (every operation leaves it trimmed to the significant limbs)
 const std::vector<uint64_t> &BigInt::get_bit_vector() const {
-    return bits;  // Return a reference to the internal bit vector
+    return *bits;  // Return a reference to the internal bit vector
 }
 
 // Addition operator for BigInt, handles both positive and negative numbers
 BigInt BigInt::operator+(const BigInt &rhs) const {
-    BigInt result;  // Initialize the result BigInt
-
-    // Both BigInts have the same sign
-    if (this->is_negative() == rhs.is_negative()) {
-        // Add the magnitudes and set the result's sign to match the operands' sign
-        result.bits = add_magnitudes(*this, rhs);
-        result.negative = this->is_negative();
-    } 
-    // BigInts have different signs (subtraction of magnitudes)
-    else {
-        // Compare magnitudes and subtract the smaller magnitude from the larger one
-        if (compare_magnitudes(*this, rhs) > 0) {
-            result.bits = subtract_magnitudes(*this, rhs);
-            result.negative = this->is_negative();
-        } else if (compare_magnitudes(*this, rhs) < 0) {
-            result.bits = subtract_magnitudes(rhs, *this);
-            result.negative = rhs.is_negative();
-        } else {
-            // If the magnitudes are equal, the result is zero
-            result.bits = subtract_magnitudes(rhs, *this);
-            result.negative = false;
-        }
-    }
-    return result;  
+    return BigIntView(*this) + BigIntView(rhs);
+}
+
+BigInt BigInt::operator+(const BigIntView &rhs) const {
+    return BigIntView(*this) + rhs;
 }
 
-// Subtraction operator, subtracts the rhs from this BigInt by adding the negation of rhs
+// Subtraction operator, subtracts the rhs from this BigInt by adding a negated view of rhs
 BigInt BigInt::operator-(const BigInt &rhs) const {
-    BigInt neg_rhs = rhs;  // Make a copy of the right-hand operand
-    neg_rhs.negative = !rhs.is_negative();  // Negate the sign of the copy
-    return *this + neg_rhs;  // Perform addition with the negated rhs
+    return BigIntView(*this) - BigIntView(rhs);
+}
+
+BigInt BigInt::operator-(const BigIntView &rhs) const {
+    return BigIntView(*this) - rhs;
 }
 
 // Unary negation operator, negates the current BigInt 
 BigInt BigInt::operator-() const {
-    BigInt result = *this;  // Copy current BigInt
+    BIGINT_OP_SCOPE(BigIntOp::NEG, len);
+    BigInt result = *this;  // Copy current BigInt (shares its bits)
     // Flip the sign if the BigInt is not zero
     if (!is_zero()) {
         result.negative = !this->negative;
@@ -103,20 +147,81 @@ BigInt BigInt::operator-() const {
 
 // Checks if the n-th bit is set in the BigInt
 bool BigInt::is_bit_set(unsigned n) const {
-    // Return false if the bit index is out of bounds (greater than total bit length)
-    if (n >= bits.size() * 64) {
-        return false;
+    // Bits past the top limb are 0
+    size_t index = n / 64;
+    return index < len && (((*bits)[index] >> (n % 64)) & 1);
+}
+
+// Number of significant bits in a nonzero magnitude
+static size_t magnitude_bits(const uint64_t *limbs, size_t count) {
+    return 64 * count - __builtin_clzll(limbs[count - 1]);
+}
+
+size_t BigInt::bit_length() const {
+    return len ? magnitude_bits(bits->data(), len) : 0;
+}
+
+size_t BigInt::countr_zero() const {
+    const uint64_t *limbs = bits->data();
+    for (size_t i = 0; i < len; ++i) {
+        if (limbs[i]) {
+            return 64 * i + __builtin_ctzll(limbs[i]);
+        }
+    }
+    return 0;
+}
+
+size_t BigInt::popcount() const {
+    const uint64_t *limbs = bits->data();
+    size_t count = 0;
+    for (size_t i = 0; i < len; ++i) {
+        count += __builtin_popcountll(limbs[i]);
     }
+    return count;
+}
+
+uint64_t BigInt::extract_bits(size_t pos, unsigned width) const {
+    if (width > 64) {
+        throw std::invalid_argument("Cannot extract more than 64 bits");
+    }
+    if (width == 0) {
+        return 0;
+    }
+    // The field spans at most two limbs
+    size_t index = pos / 64;
+    unsigned shift = pos % 64;
+    uint64_t field = get_bits(index) >> shift;
+    if (shift && shift + width > 64) {
+        field |= get_bits(index + 1) << (64 - shift);
+    }
+    return width == 64 ? field : field & ((uint64_t(1) << width) - 1);
+}
 
-    // Calculate which word contains the bit and its position within the word
-    size_t index = n / 64;  // Index of the 64-bit word
-    size_t bit_position = n % 64;  // Bit position within the 64-bit word
+void BigInt::set_bit(size_t n) {
+    size_t index = n / 64;
+    std::vector<uint64_t> &r = mutable_bits();
+    if (r.size() <= index) {
+        r.resize(index + 1, 0);
+    }
+    r[index] |= uint64_t(1) << (n % 64);
+    len = std::max(len, index + 1);
+}
 
-    // Check if the bit is set 
-    return (bits[index] & (1ULL << bit_position)) != 0;
+void BigInt::clear_bit(size_t n) {
+    size_t index = n / 64;
+    if (index >= len || !(((*bits)[index] >> (n % 64)) & 1)) {
+        return;  // already clear; don't detach shared storage
+    }
+    std::vector<uint64_t> &r = mutable_bits();
+    r[index] &= ~(uint64_t(1) << (n % 64));
+    len = mpn_normalized_size(r.data(), len);
+    r.resize(std::max<size_t>(len, 1));
+    negative = negative && len > 0;
 }
 
 BigInt BigInt::operator<<(unsigned n) const {
+    BIGINT_OP_SCOPE(BigIntOp::LSHIFT, len);
+
     if (n == 0 || is_zero()) {
         return *this; // No shift needed
     }
@@ -130,155 +235,791 @@ BigInt BigInt::operator<<(unsigned n) const {
 
     size_t bit_shift = n % 64; // Number of bits to shift within the word
 
-    // Create a new BigInt to store the result and resize its bit vector to accommodate the shift
-    BigInt result;
-    result.bits.resize(bits.size() + full_words_shift + 1, 0);  
+    // Create the result's bit vector, sized to accommodate the shift:
+    // whole words move up, and the bits shifted out of the top word
+    // land in the extra limb
+    const uint64_t *src = bits->data();
+    std::vector<uint64_t> result_bits(len + full_words_shift + 1, 0);
+    if (bit_shift) {
+        result_bits.back() = mpn_lshift(result_bits.data() + full_words_shift, src, len, bit_shift);
+    } else {
+        std::copy(src, src + len, result_bits.begin() + full_words_shift);
+    }
 
-    for (size_t i = 0; i < bits.size(); ++i) {
-        // If a bit shift is needed, handle both the shift and overflow
-        if (bit_shift) {
-            // Shift the current word left by bit_shift and store it at the correct position in the result
-            result.bits[i + full_words_shift] |= (bits[i] << bit_shift);
+    // The constructor skips a zero top limb; the sign is the original's
+    return BigInt(std::move(result_bits), negative);
+}
 
-            // Handles overflow, as bits that shift out of the left side are carried into the next word
-            if (i + full_words_shift + 1 < result.bits.size()) {
-                result.bits[i + full_words_shift + 1] |= (bits[i] >> (64 - bit_shift));
-            }
-        } else {
-            // If no bit shift needed, move word to the correct position
-            result.bits[i + full_words_shift] = bits[i];
-        }
+BigInt BigInt::operator>>(unsigned n) const {
+    if (n == 0 || is_zero()) {
+        return *this; // No shift needed
     }
 
-    // Remove leading zeros from the result to ensure it has the correct magnitude representation
-    while (result.bits.size() > 1 && result.bits.back() == 0) {
-        result.bits.pop_back(); 
+    // Same restriction as left shift
+    if (is_negative()) {
+        throw std::invalid_argument("Cannot shift negative BigInt");
     }
 
-    // Copy the sign from the original BigInt to the result
-    result.negative = negative;  
+    size_t full_words_shift = n / 64; // Number of full 64-bit words to drop
+    size_t bit_shift = n % 64; // Number of bits to shift within the word
 
-    return result;
+    if (full_words_shift >= len) {
+        return BigInt();
+    }
+
+    const uint64_t *src = bits->data();
+    std::vector<uint64_t> result_bits(src + full_words_shift, src + len);
+    if (bit_shift) {
+        mpn_rshift(result_bits.data(), result_bits.data(), result_bits.size(), bit_shift);
+    }
+
+    return BigInt(std::move(result_bits), false);
 }
 
 BigInt BigInt::operator*(const BigInt &rhs) const {
-    // Handle trivial cases like multiplying by zero
-    if (this->is_zero() || rhs.is_zero()) {
-        return BigInt();  // Return zero
+    return BigIntView(*this) * BigIntView(rhs);
+}
+
+BigInt BigInt::operator*(const BigIntView &rhs) const {
+    return BigIntView(*this) * rhs;
+}
+
+// Thread cap for multiplication (0 means "use the hardware thread count")
+static std::atomic<unsigned> max_mul_threads(0);
+
+// Number of extra worker threads currently running multiplication subproducts
+static std::atomic<unsigned> active_mul_threads(0);
+
+void BigInt::set_max_threads(unsigned n) {
+    max_mul_threads = n;
+}
+
+unsigned BigInt::get_max_threads() {
+    unsigned n = max_mul_threads;
+    if (n == 0) {
+        n = std::thread::hardware_concurrency();
     }
+    return n > 0 ? n : 1;
+}
 
-    // Determine the sign of the result
-    bool result_negative = (this->is_negative() != rhs.is_negative());
+// Try to reserve one worker thread from the multiplication thread budget.
+// The calling thread counts against the cap, so a cap of 1 never spawns.
+static bool acquire_mul_thread() {
+    unsigned limit = BigInt::get_max_threads() - 1;
+    unsigned cur = active_mul_threads.load();
+    while (cur < limit) {
+        if (active_mul_threads.compare_exchange_weak(cur, cur + 1)) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    // Create absolute values of both operands to avoid shifting negative numbers
-    BigInt abs_this = this->is_negative() ? -*this : *this;
-    BigInt abs_rhs = rhs.is_negative() ? -rhs : rhs;
+static void release_mul_thread() {
+    active_mul_threads.fetch_sub(1);
+}
 
-    // Initialize the result BigInt to zero
-    BigInt result(0, false);
+bool BigInt::ThreadSlot::acquire() {
+    if (!held) {
+        held = acquire_mul_thread();
+    }
+    return held;
+}
+
+void BigInt::ThreadSlot::release() {
+    if (held) {
+        release_mul_thread();
+        held = false;
+    }
+}
+
+static void mul_limbs(uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b, size_t bn);
+
+// Karatsuba product of two n-limb operands into r (2n limbs).
+// Above PARALLEL_MUL_THRESHOLD the high and middle subproducts are
+// computed on worker threads while this thread computes the low one.
+static void mul_karatsuba(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n) {
+    size_t lo = n / 2;       // size of the low halves
+    size_t hi = n - lo;      // size of the high halves (hi >= lo)
+
+    // Sums of the halves, each with room for a carry limb
+    std::vector<uint64_t> sa(a + lo, a + n), sb(b + lo, b + n);
+    sa.push_back(mpn_add(sa.data(), sa.data(), hi, a, lo));
+    sb.push_back(mpn_add(sb.data(), sb.data(), hi, b, lo));
+
+    std::vector<uint64_t> mid(2 * (hi + 1));
+    auto compute_high = [&]() { mul_limbs(r + 2 * lo, a + lo, hi, b + lo, hi); };
+    auto compute_mid = [&]() { mul_limbs(mid.data(), sa.data(), hi + 1, sb.data(), hi + 1); };
+
+    // The slots outlive the futures, whose destructors wait for the
+    // tasks, so a slot is only given back once its task has finished
+    BigInt::ThreadSlot high_slot, mid_slot;
+    std::future<void> high_task, mid_task;
+    bool high_async = false, mid_async = false;
+    if (n >= BigInt::PARALLEL_MUL_THRESHOLD) {
+        if (high_slot.acquire()) {
+            high_task = std::async(std::launch::async, compute_high);
+            high_async = true;
+        }
+        if (mid_slot.acquire()) {
+            mid_task = std::async(std::launch::async, compute_mid);
+            mid_async = true;
+        }
+    }
+
+    mul_limbs(r, a, lo, b, lo);
+    if (!high_async) {
+        compute_high();
+    }
+    if (!mid_async) {
+        compute_mid();
+    }
+    if (high_async) {
+        high_task.get();
+    }
+    if (mid_async) {
+        mid_task.get();
+    }
+
+    // mid = (a0 + a1)(b0 + b1) - a0*b0 - a1*b1 = a0*b1 + a1*b0
+    mpn_sub(mid.data(), mid.data(), mid.size(), r, 2 * lo);
+    mpn_sub(mid.data(), mid.data(), mid.size(), r + 2 * lo, 2 * hi);
+
+    // The middle term fits in 2 * hi + 1 limbs; the top limb is always 0
+    size_t mid_size = mpn_normalized_size(mid.data(), mid.size());
+    mpn_add(r + lo, r + lo, 2 * n - lo, mid.data(), mid_size);
+}
+
+// Product of a (an limbs) and b (bn limbs) into r (an + bn limbs),
+// dispatching to the schoolbook or Karatsuba algorithm by size
+static void mul_limbs(uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b, size_t bn) {
+    if (an < bn) {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+
+    if (bn < BigInt::KARATSUBA_THRESHOLD) {
+        mpn_mul_basecase(r, a, an, b, bn);
+        return;
+    }
 
-    // Loop over each bit in abs_rhs (the absolute value of rhs)
-    for (size_t i = 0; i < abs_rhs.bits.size(); ++i) {
-        for (uint64_t bit_pos = 0; bit_pos < 64; ++bit_pos) {
-            if (abs_rhs.is_bit_set(i * 64 + bit_pos)) {
-                // If the bit is set, add `abs_this << bit_pos` to the result
-                BigInt shifted = abs_this << (i * 64 + bit_pos);
-                result = result + shifted;
+    if (an == bn) {
+        mul_karatsuba(r, a, b, an);
+        return;
+    }
+
+    // Unbalanced operands: multiply b by bn-limb slices of a and accumulate
+    std::fill(r, r + an + bn, 0);
+    std::vector<uint64_t> partial(2 * bn);
+    for (size_t off = 0; off < an; off += bn) {
+        size_t len = std::min(bn, an - off);
+        mul_limbs(partial.data(), a + off, len, b, bn);
+        mpn_add(r + off, r + off, an + bn - off, partial.data(), len + bn);
+    }
+}
+
+void BigInt::add_product(const BigIntView &a, const BigIntView &b, bool subtract) {
+    BIGINT_OP_SCOPE(BigIntOp::MUL, a.size() + b.size());
+
+    if (a.is_zero() || b.is_zero()) {
+        return;
+    }
+    const BigIntView &x = (a.size() >= b.size()) ? a : b;  // longer factor
+    const BigIntView &y = (a.size() >= b.size()) ? b : a;
+    bool product_negative = (a.is_negative() != b.is_negative()) != subtract;
+
+    // Small products are added row by row, straight into the limbs.
+    // Large ones (and factors living in these very limbs, which the
+    // rows would overwrite) are multiplied into a scratch buffer first.
+    const uint64_t *begin = bits->data(), *end = begin + len;
+    auto overlaps = [begin, end](const BigIntView &v) {
+        return v.data() < end && v.data() + v.size() > begin;
+    };
+    bool by_rows = y.size() < KARATSUBA_THRESHOLD && !overlaps(a) && !overlaps(b);
+    std::vector<uint64_t> product;
+    if (!by_rows) {
+        product.resize(x.size() + y.size());
+        mul_limbs(product.data(), x.data(), x.size(), y.data(), y.size());
+    }
+
+    // Like signs add magnitudes; unlike signs subtract the product's
+    bool acc_zero = is_zero();
+    bool add = acc_zero || negative == product_negative;
+    bool result_negative = acc_zero ? product_negative : negative;
+
+    // Trimming keeps the capacity, so a buffer left long enough by an
+    // earlier call grows again without reallocating
+    std::vector<uint64_t> &r = mutable_bits();
+    size_t n = std::max(len, x.size() + y.size()) + 1;
+    if (r.size() < n) {
+        r.resize(n, 0);
+    }
+
+    uint64_t borrow = 0;
+    if (by_rows) {
+        for (size_t j = 0; j < y.size(); ++j) {
+            uint64_t *row = r.data() + j;
+            uint64_t *above = row + x.size();
+            size_t rest = n - j - x.size();
+            if (add) {
+                mpn_add_1(above, above, rest, mpn_addmul_1(row, x.data(), x.size(), y.data()[j]));
+            } else {
+                borrow += mpn_sub_1(above, above, rest, mpn_submul_1(row, x.data(), x.size(), y.data()[j]));
             }
         }
+    } else if (add) {
+        mpn_add(r.data(), r.data(), n, product.data(), product.size());
+    } else {
+        borrow = mpn_sub(r.data(), r.data(), n, product.data(), product.size());
     }
 
-    // Remove leading zeros in the result
-    while (result.bits.size() > 1 && result.bits.back() == 0) {
-        result.bits.pop_back();
+    // The subtraction wrapped around (at most once): the product had
+    // the larger magnitude, so the result takes its sign
+    if (borrow) {
+        mpn_neg(r.data(), r.data(), n);
+        result_negative = !result_negative;
     }
 
-    // Set the correct sign
-    result.negative = result_negative;
+    len = mpn_normalized_size(r.data(), n);
+    r.resize(std::max<size_t>(len, 1));
+    negative = result_negative && len > 0;
+}
+
+void addmul(BigInt &acc, const BigIntView &a, const BigIntView &b) {
+    acc.add_product(a, b, false);
+}
+
+void submul(BigInt &acc, const BigIntView &a, const BigIntView &b) {
+    acc.add_product(a, b, true);
+}
 
+BigInt fma(const BigIntView &a, const BigIntView &b, const BigInt &c) {
+    BigInt result = c;  // shares c's limbs until the product is added
+    addmul(result, a, b);
     return result;
 }
 
+// Compare the magnitudes of two (normalized) views
+static int compare_magnitudes(const BigIntView &lhs, const BigIntView &rhs) {
+    if (lhs.size() != rhs.size()) {
+        return lhs.size() > rhs.size() ? 1 : -1;
+    }
+    return mpn_cmp(lhs.data(), rhs.data(), lhs.size());
+}
+
+// Truncating division: the quotient is rounded toward zero
 BigInt BigInt::operator/(const BigInt &rhs) const {
+    BIGINT_OP_SCOPE(BigIntOp::DIV, len + rhs.len);
+
+    BigIntView dividend(*this), divisor(rhs);
+
     // Handle edge cases: Division by zero
-    if (rhs.is_zero()) {
+    if (divisor.is_zero()) {
         throw std::invalid_argument("Division by zero");
     }
 
-    // Edge case: If the dividend is zero, return 0
-    if (this->is_zero()) {
-        return BigInt();  // Return 0
+    // Handle case where dividend is smaller than divisor (including a zero dividend)
+    if (compare_magnitudes(dividend, divisor) < 0) {
+        return BigInt();  // Quotient is 0
     }
 
     // Edge case: If dividing by 1 or -1, return the dividend or negated dividend
-    if (rhs == BigInt(1, false)) {
+    if (divisor.size() == 1 && divisor.data()[0] == 1) {
+        return divisor.is_negative() ? -*this : *this;
+    }
+
+    std::vector<uint64_t> quotient(dividend.size() - divisor.size() + 1);
+    std::vector<uint64_t> remainder(divisor.size());
+    mpn_tdiv_qr(quotient.data(), remainder.data(), dividend.data(), dividend.size(),
+                divisor.data(), divisor.size());
+
+    return BigInt(std::move(quotient), dividend.is_negative() != divisor.is_negative());
+}
+
+BigInt BigInt::operator%(const BigInt &rhs) const {
+    BIGINT_OP_SCOPE(BigIntOp::DIV, len + rhs.len);
+
+    BigIntView dividend(*this), divisor(rhs);
+    if (divisor.is_zero()) {
+        throw std::invalid_argument("Division by zero");
+    }
+
+    // The dividend is its own remainder when its magnitude is smaller
+    if (compare_magnitudes(dividend, divisor) < 0) {
         return *this;
     }
-    if (rhs == BigInt(1, true)) {
-        return -*this;
+
+    std::vector<uint64_t> quotient(dividend.size() - divisor.size() + 1);
+    std::vector<uint64_t> remainder(divisor.size());
+    mpn_tdiv_qr(quotient.data(), remainder.data(), dividend.data(), dividend.size(),
+                divisor.data(), divisor.size());
+
+    return BigInt(std::move(remainder), dividend.is_negative());
+}
+
+// Magnitude of a signed word (also correct for INT64_MIN)
+static uint64_t word_magnitude(int64_t v) {
+    return v < 0 ? uint64_t(0) - static_cast<uint64_t>(v) : static_cast<uint64_t>(v);
+}
+
+BigInt BigInt::add_word(const BigIntView &a, uint64_t b, bool b_negative) {
+    BIGINT_OP_SCOPE(BigIntOp::ADD, a.size() + 1);
+    size_t n = a.size();
+
+    // Same signs (or a zero): add the magnitudes, with room for a carry
+    if (a.is_negative() == b_negative || n == 0) {
+        std::vector<uint64_t> result_bits(n + 1);
+        result_bits[n] = mpn_add_1(result_bits.data(), a.data(), n, b);
+        return BigInt(std::move(result_bits), a.is_negative() || b_negative);
     }
 
-    BigInt dividend = *this;  // Copy of the dividend
-    BigInt divisor = rhs;     // Copy of the divisor
-    dividend.negative = false;
-    divisor.negative = false;
+    // Different signs: subtract the smaller magnitude from the larger one
+    if (n > 1 || a.data()[0] >= b) {
+        std::vector<uint64_t> result_bits(n);
+        mpn_sub_1(result_bits.data(), a.data(), n, b);
+        return BigInt(std::move(result_bits), a.is_negative());
+    }
+    return BigInt(std::vector<uint64_t>(1, b - a.data()[0]), b_negative);
+}
 
-    // Handle case where dividend is smaller than divisor
-    if (compare_magnitudes(dividend, divisor) < 0) {
-        return BigInt(0, false);  // Quotient is 0
+BigInt BigInt::mul_word(const BigIntView &a, uint64_t b, bool b_negative) {
+    BIGINT_OP_SCOPE(BigIntOp::MUL, a.size() + 1);
+    size_t n = a.size();
+    std::vector<uint64_t> result_bits(n + 1);
+    result_bits[n] = mpn_mul_1(result_bits.data(), a.data(), n, b);
+    return BigInt(std::move(result_bits), a.is_negative() != b_negative);
+}
+
+BigInt BigInt::operator+(uint64_t rhs) const {
+    return add_word(*this, rhs, false);
+}
+
+BigInt BigInt::operator+(int64_t rhs) const {
+    return add_word(*this, word_magnitude(rhs), rhs < 0);
+}
+
+BigInt BigInt::operator-(uint64_t rhs) const {
+    return add_word(*this, rhs, true);
+}
+
+BigInt BigInt::operator-(int64_t rhs) const {
+    return add_word(*this, word_magnitude(rhs), rhs >= 0);
+}
+
+BigInt BigInt::operator*(uint64_t rhs) const {
+    return mul_word(*this, rhs, false);
+}
+
+BigInt BigInt::operator*(int64_t rhs) const {
+    return mul_word(*this, word_magnitude(rhs), rhs < 0);
+}
+
+BigInt BigInt::operator/(uint64_t rhs) const {
+    return divrem(*this, rhs).first;
+}
+
+BigInt BigInt::operator/(int64_t rhs) const {
+    BigInt quotient = divrem(*this, word_magnitude(rhs)).first;
+    return rhs < 0 ? -quotient : quotient;
+}
+
+// The remainder takes the dividend's sign, whatever the divisor's
+BigInt BigInt::operator%(uint64_t rhs) const {
+    uint64_t remainder = divrem(*this, rhs).second;
+    return BigInt(std::vector<uint64_t>(1, remainder), negative);
+}
+
+BigInt BigInt::operator%(int64_t rhs) const {
+    return *this % word_magnitude(rhs);
+}
+
+std::pair<BigInt, uint64_t> divrem(const BigInt &dividend, uint64_t divisor) {
+    BigIntView num(dividend);
+    BIGINT_OP_SCOPE(BigIntOp::DIV, num.size() + 1);
+
+    if (divisor == 0) {
+        throw std::invalid_argument("Division by zero");
+    }
+
+    std::vector<uint64_t> quotient(num.size());
+    uint64_t remainder = mpn_divrem_1(quotient.data(), num.data(), num.size(), divisor);
+    return { BigInt(std::move(quotient), num.is_negative()), remainder };
+}
+
+
+int BigInt::compare(const BigInt &rhs) const {
+    return BigIntView(*this).compare(BigIntView(rhs));
+}
+
+int BigInt::compare(const BigIntView &rhs) const {
+    return BigIntView(*this).compare(rhs);
+}
+
+int BigInt::compare(uint64_t rhs) const {
+    BigIntView lhs(*this);
+    BIGINT_OP_SCOPE(BigIntOp::COMPARE, lhs.size() + 1);
+
+    if (lhs.is_negative()) {
+        return -1;
+    }
+    if (lhs.size() > 1) {
+        return 1;
+    }
+    uint64_t val = lhs.get_bits(0);
+    return (val > rhs) - (val < rhs);
+}
+
+int BigInt::compare(int64_t rhs) const {
+    if (rhs >= 0) {
+        return compare(static_cast<uint64_t>(rhs));
+    }
+
+    BigIntView lhs(*this);
+    BIGINT_OP_SCOPE(BigIntOp::COMPARE, lhs.size() + 1);
+
+    // Both negative: the larger magnitude is the smaller value
+    if (!lhs.is_negative()) {
+        return 1;
+    }
+    if (lhs.size() > 1) {
+        return -1;
     }
+    uint64_t val = lhs.get_bits(0), mag = word_magnitude(rhs);
+    return (mag > val) - (mag < val);
+}
+
+
+std::string BigInt::to_hex() const {
+    return BigIntView(*this).to_hex();
+}
+
+
+bool BigInt::is_zero() const {
+    return len == 0;
+}
+
+std::string BigInt::to_dec() const {
+    return BigIntView(*this).to_dec();
+}
+
+std::string BigInt::to_string(unsigned base) const {
+    return BigIntView(*this).to_string(base);
+}
+
+// Store/load a uint64_t as 8 little-endian bytes regardless of host byte order
+static void store_le64(uint8_t *p, uint64_t v) {
+    for (int i = 0; i < 8; ++i) {
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+}
+
+static uint64_t load_le64(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 8; i-- > 0; ) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+// Parse and validate the header of the fixed serialized form
+static size_t serialized_limb_count(const uint8_t *buf, size_t len, bool &negative) {
+    if (len < 8) {
+        throw std::invalid_argument("Truncated BigInt header");
+    }
+    uint64_t header = load_le64(buf);
+    uint64_t count = header >> 1;
+    if (count > (len - 8) / 8) {
+        throw std::invalid_argument("Truncated BigInt limbs");
+    }
+    negative = (header & 1) != 0;
+    return static_cast<size_t>(count);
+}
 
-    // Determine the sign of the result
-    bool result_negative = (this->is_negative() != rhs.is_negative());
+size_t BigInt::serialized_size() const {
+    return 8 * (1 + BigIntView(*this).size());
+}
 
-    // Binary search to find the quotient
-    BigInt quotient = binary_search_quotient(dividend, divisor);
+void BigInt::serialize(uint8_t *buf) const {
+    BigIntView view(*this);
+    store_le64(buf, (static_cast<uint64_t>(view.size()) << 1) | (view.is_negative() ? 1 : 0));
+    for (size_t i = 0; i < view.size(); ++i) {
+        store_le64(buf + 8 * (i + 1), view.data()[i]);
+    }
+}
 
-    // Set the sign of the result
-    quotient.negative = result_negative;
+std::vector<uint8_t> BigInt::serialize() const {
+    std::vector<uint8_t> buf(serialized_size());
+    serialize(buf.data());
+    return buf;
+}
 
-    // Remove leading zeros
-    while (quotient.bits.size() > 1 && quotient.bits.back() == 0) {
-        quotient.bits.pop_back();
+BigInt BigInt::deserialize(const uint8_t *buf, size_t len) {
+    bool negative;
+    size_t count = serialized_limb_count(buf, len, negative);
+    std::vector<uint64_t> limbs(count);
+    for (size_t i = 0; i < count; ++i) {
+        limbs[i] = load_le64(buf + 8 * (i + 1));
     }
+    return BigInt(std::move(limbs), negative);
+}
 
-    return quotient;
+BigIntView BigInt::deserialize_view(const uint8_t *buf, size_t len) {
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+    throw std::invalid_argument("Zero-copy deserialization requires a little-endian host");
+#endif
+    if (reinterpret_cast<uintptr_t>(buf) % alignof(uint64_t) != 0) {
+        throw std::invalid_argument("Serialized BigInt is not 8-byte aligned");
+    }
+    bool negative;
+    size_t count = serialized_limb_count(buf, len, negative);
+    return BigIntView(reinterpret_cast<const uint64_t *>(buf + 8), count, negative);
 }
 
-// Helper function for binary search
-BigInt BigInt::binary_search_quotient(const BigInt &dividend, const BigInt &divisor) const {
-    // Binary search bounds: low = 0, high = dividend
-    BigInt low(0, false);
-    BigInt high = dividend;
-    BigInt quotient(0, false);  // To store the final quotient
+std::vector<uint8_t> BigInt::to_bytes() const {
+    BigIntView view(*this);
+
+    // Number of significant magnitude bytes
+    size_t nbytes = 0;
+    if (!view.is_zero()) {
+        uint64_t top = view.data()[view.size() - 1];
+        nbytes = 8 * (view.size() - 1);
+        while (top != 0) {
+            ++nbytes;
+            top >>= 8;
+        }
+    }
+
+    std::vector<uint8_t> out;
+    out.reserve(nbytes + 10);
 
-    while (low <= high) {
-        // Midpoint of the binary search range
-        BigInt mid = (low + high).div_by_2();
-        BigInt product = mid * divisor;
+    // LEB128 header: 7 bits per byte, high bit set on all but the last byte
+    uint64_t header = (static_cast<uint64_t>(nbytes) << 1) | (view.is_negative() ? 1 : 0);
+    do {
+        uint8_t byte = header & 0x7F;
+        header >>= 7;
+        out.push_back(header ? (byte | 0x80) : byte);
+    } while (header);
 
-        // Exact match, stop here
-        if (product == dividend) {
-            quotient = mid;
+    // Big-endian magnitude
+    for (size_t i = nbytes; i-- > 0; ) {
+        out.push_back(static_cast<uint8_t>(view.data()[i / 8] >> (8 * (i % 8))));
+    }
+
+    return out;
+}
+
+BigInt BigInt::from_bytes(const uint8_t *buf, size_t len, size_t *consumed) {
+    uint64_t header = 0;
+    size_t pos = 0;
+    for (unsigned shift = 0; ; shift += 7) {
+        if (pos >= len) {
+            throw std::invalid_argument("Truncated BigInt byte header");
+        }
+        if (shift >= 64) {
+            throw std::invalid_argument("Malformed BigInt byte header");
+        }
+        uint8_t byte = buf[pos++];
+        // The tenth byte holds only bit 63, and a final zero byte after
+        // the first would be padding: to_bytes writes neither
+        if ((shift == 63 && (byte & 0x7F) > 1) || (shift > 0 && byte == 0)) {
+            throw std::invalid_argument("Overlong BigInt byte header");
+        }
+        header |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
             break;
         }
-        // If product is less than dividend, move the lower bound up
-        else if (product < dividend) {
-            quotient = mid;  // Update quotient
-            low = mid + BigInt(1, false);  // Narrow the range upwards
+    }
+
+    uint64_t nbytes = header >> 1;
+    if (nbytes > len - pos) {
+        throw std::invalid_argument("Truncated BigInt bytes");
+    }
+
+    std::vector<uint64_t> limbs((nbytes + 7) / 8, 0);
+    for (size_t i = 0; i < nbytes; ++i) {
+        limbs[i / 8] |= static_cast<uint64_t>(buf[pos + nbytes - 1 - i]) << (8 * (i % 8));
+    }
+    pos += nbytes;
+
+    if (consumed) {
+        *consumed = pos;
+    }
+    return BigInt(std::move(limbs), (header & 1) != 0 && nbytes > 0);
+}
+
+// The 128 bits of a magnitude starting at bit `pos` (fewer at the top)
+static unsigned __int128 bit_window(const BigIntView &val, size_t pos) {
+    size_t limb = pos / 64;
+    unsigned shift = pos % 64;
+    unsigned __int128 w = ((unsigned __int128) val.get_bits(limb + 1) << 64) | val.get_bits(limb);
+    if (shift) {
+        w = (w >> shift) | ((unsigned __int128) val.get_bits(limb + 2) << (128 - shift));
+    }
+    return w;
+}
+
+// True if any of the low `n` bits of a magnitude is set
+static bool low_bits_set(const BigIntView &val, size_t n) {
+    size_t limb = n / 64;
+    for (size_t i = 0; i < limb; ++i) {
+        if (val.data()[i]) {
+            return true;
         }
-        // If product is greater than dividend, move the upper bound down
-        else {
-            high = mid - BigInt(1, false);  // Narrow the range downwards
+    }
+    return n % 64 && (val.get_bits(limb) & ((uint64_t(1) << (n % 64)) - 1));
+}
+
+// Round a nonzero magnitude to the P-bit mantissa of F, ties to even:
+// only the top 128 bits are read, and the bits below them only when
+// the rest of the window is exactly a tie
+template <typename F>
+static F magnitude_to_float(const BigIntView &val) {
+    const int P = std::numeric_limits<F>::digits;
+    size_t nbits = magnitude_bits(val.data(), val.size());
+    size_t below = nbits > 128 ? nbits - 128 : 0;  // bits below the window
+    unsigned __int128 w = bit_window(val, below);
+    size_t wbits = nbits - below;
+
+    unsigned __int128 mant = w;
+    size_t exp = below;
+    if (wbits > static_cast<size_t>(P)) {
+        size_t drop = wbits - P;
+        mant = w >> drop;
+        exp += drop;
+        unsigned __int128 half = (unsigned __int128) 1 << (drop - 1);
+        unsigned __int128 rest = w & ((half << 1) - 1);
+        if (rest > half || (rest == half && ((mant & 1) || low_bits_set(val, below)))) {
+            ++mant;  // may carry into bit P, which is still exact
         }
     }
 
-    return quotient;
+    // Past the largest exponent, ldexp overflows to infinity
+    int e = static_cast<int>(std::min<size_t>(exp, std::numeric_limits<F>::max_exponent + 1));
+    F result = std::ldexp(static_cast<F>(static_cast<uint64_t>(mant >> 64)), e + 64)
+             + std::ldexp(static_cast<F>(static_cast<uint64_t>(mant)), e);
+    return val.is_negative() ? -result : result;
 }
 
+// Integer part of a finite F, from its mantissa and exponent
+template <typename F>
+static BigInt float_to_bigint(F d) {
+    if (!std::isfinite(d)) {
+        throw std::invalid_argument("Cannot convert an infinite or NaN value to BigInt");
+    }
+    const int P = std::numeric_limits<F>::digits;
+    int exp;
+    F frac = std::frexp(std::fabs(std::trunc(d)), &exp);  // |d| = frac * 2^exp
+    if (frac == 0) {
+        return BigInt();
+    }
 
-int BigInt::compare(const BigInt &rhs) const {
+    // The mantissa as a P-bit integer: |d| = mant * 2^(exp - P)
+    uint64_t mant = static_cast<uint64_t>(std::ldexp(frac, P));
+    BigInt result(mant, false);
+    if (exp > P) {
+        result = result << (exp - P);
+    } else {
+        result = result >> (P - exp);  // drops only zero bits: d was truncated
+    }
+    return d < 0 ? -result : result;
+}
+
+double BigInt::to_double() const {
+    return is_zero() ? 0.0 : magnitude_to_float<double>(*this);
+}
+
+long double BigInt::to_long_double() const {
+    return is_zero() ? 0.0L : magnitude_to_float<long double>(*this);
+}
+
+BigInt BigInt::from_double(double d) {
+    return float_to_bigint(d);
+}
+
+BigInt BigInt::from_long_double(long double d) {
+    return float_to_bigint(d);
+}
+
+double BigInt::log2_approx() const {
+    if (is_zero()) {
+        return -std::numeric_limits<double>::infinity();
+    }
+    // log2(top 64 bits) plus the number of bits below them
+    BigIntView val(*this);
+    size_t nbits = magnitude_bits(val.data(), val.size());
+    size_t below = nbits > 64 ? nbits - 64 : 0;
+    uint64_t top = static_cast<uint64_t>(bit_window(val, below));
+    return static_cast<double>(below) + std::log2(static_cast<double>(top));
+}
+
+// Views normalize away leading zero limbs so that magnitude comparison
+// can go by limb count, and never report a negative zero
+BigIntView::BigIntView(const uint64_t *limbs, size_t count, bool negative)
+    : limbs(limbs), count(count), negative(false) {
+
+    while (this->count > 0 && limbs[this->count - 1] == 0) {
+        --this->count;  // Ignore the most significant zeroes
+    }
+    this->negative = negative && this->count > 0;
+}
+
+// A BigInt already knows its length, so there is nothing to skip
+BigIntView::BigIntView(const BigInt &val)
+    : limbs(val.bits->data()), count(val.len), negative(val.negative && val.len > 0) {}
+
+BigInt BigIntView::to_bigint() const {
+    return BigInt(std::vector<uint64_t>(limbs, limbs + count), negative);
+}
+
+BigIntView BigIntView::operator-() const {
+    return BigIntView(limbs, count, !negative);
+}
+
+BigInt BigIntView::operator+(const BigIntView &rhs) const {
+    BIGINT_OP_SCOPE(BigIntOp::ADD, size() + rhs.size());
+
+    // Order the operands by magnitude, so the kernels see the longer one first
     int magnitude_comparison = compare_magnitudes(*this, rhs);
+    const BigIntView &big = (magnitude_comparison >= 0) ? *this : rhs;
+    const BigIntView &small = (magnitude_comparison >= 0) ? rhs : *this;
+
+    // Both values have the same sign: add the magnitudes, with room for a carry
+    if (is_negative() == rhs.is_negative()) {
+        std::vector<uint64_t> result_bits(big.size() + 1);
+        result_bits[big.size()] = mpn_add(result_bits.data(), big.data(), big.size(), small.data(), small.size());
+        return BigInt(std::move(result_bits), is_negative());
+    }
+
+    // Values have different signs: subtract the smaller magnitude from
+    // the larger one, whose sign the result takes
+    if (magnitude_comparison == 0) {
+        return BigInt();  // If the magnitudes are equal, the result is zero
+    }
+    std::vector<uint64_t> result_bits(big.size());
+    mpn_sub(result_bits.data(), big.data(), big.size(), small.data(), small.size());
+    return BigInt(std::move(result_bits), big.is_negative());
+}
+
+BigInt BigIntView::operator-(const BigIntView &rhs) const {
+    BIGINT_OP_SCOPE(BigIntOp::SUB, size() + rhs.size());
+    return *this + -rhs;
+}
+
+BigInt BigIntView::operator*(const BigIntView &rhs) const {
+    BIGINT_OP_SCOPE(BigIntOp::MUL, size() + rhs.size());
+
+    // Handle trivial cases like multiplying by zero
+    if (is_zero() || rhs.is_zero()) {
+        return BigInt();  // Return zero
+    }
+
+    std::vector<uint64_t> result_bits(size() + rhs.size());
+    mul_limbs(result_bits.data(), data(), size(), rhs.data(), rhs.size());
+    return BigInt(std::move(result_bits), is_negative() != rhs.is_negative());
+}
+
+int BigIntView::compare(const BigIntView &rhs) const {
+    BIGINT_OP_SCOPE(BigIntOp::COMPARE, size() + rhs.size());
 
     if (is_negative() && !rhs.is_negative()) {
         return -1;  // Negative is always smaller than positive
@@ -288,113 +1029,404 @@ int BigInt::compare(const BigInt &rhs) const {
         return 1;  // Positive is always greater than negative
     }
 
+    int magnitude_comparison = compare_magnitudes(*this, rhs);
+
     // Both are negative, so we reverse the magnitude comparison
     // because a larger magnitude in negative numbers means a smaller value.
-    if (is_negative() && rhs.is_negative()) {
-        return -magnitude_comparison;  // Reverse the result for negative numbers
+    if (is_negative()) {
+        return -magnitude_comparison;
     }
 
     // Both numbers are non-negative, return the normal magnitude comparison
     return magnitude_comparison;
 }
 
+// Powers of one radix for conversion, shared by all threads. A chunk
+// is `digits` digits, the most that fit in a limb, so chunks are
+// base-`big` digits; level j of the cache holds big^(2^j). Levels are
+// computed on first use under `grow_lock` and published with a
+// release store, so readers never lock. They are never freed.
+struct RadixPowers {
+    static const size_t MAX_LEVELS = 48;
+
+    unsigned base;
+    unsigned digits;      // digits per chunk
+    uint64_t big;         // base^digits
+    LimbDivisor divisor;  // big, prepared for mpn_divrem_1_preinv
+    std::atomic<const BigInt *> levels[MAX_LEVELS];
+    std::mutex grow_lock;
+
+    void init(unsigned b);
+    const BigInt &level(size_t j);  // big^(2^j)
+};
+
+void RadixPowers::init(unsigned b) {
+    base = b;
+    digits = 1;
+    big = b;
+    while (big <= UINT64_MAX / b) {
+        big *= b;
+        ++digits;
+    }
+    divisor = mpn_limb_divisor(big);
+    for (size_t j = 0; j < MAX_LEVELS; ++j) {
+        levels[j].store(nullptr, std::memory_order_relaxed);
+    }
+}
 
-std::string BigInt::to_hex() const {
-    std::ostringstream oss;  
+const BigInt &RadixPowers::level(size_t j) {
+    const BigInt *p = levels[j].load(std::memory_order_acquire);
+    if (p) {
+        return *p;
+    }
 
-    // If BigInt is zero, return "0"
-    if (is_zero()) {
-        return "0";
+    // Square up from the highest level present (another thread may
+    // have added some while this one waited for the lock)
+    std::lock_guard<std::mutex> guard(grow_lock);
+    for (size_t i = 0; i <= j; ++i) {
+        if (levels[i].load(std::memory_order_relaxed)) {
+            continue;
+        }
+        const BigInt *next = (i == 0) ? new BigInt(big)
+                                      : new BigInt(*levels[i - 1] * *levels[i - 1]);
+        levels[i].store(next, std::memory_order_release);
     }
+    return *levels[j].load(std::memory_order_relaxed);
+}
 
-    // If the BigInt is negative, prepend a negative sign to  output
-    if (is_negative()) {
-        oss << "-";
+static void check_base(unsigned base) {
+    if (base < 2 || base > 36) {
+        throw std::invalid_argument("Base must be between 2 and 36");
     }
+}
 
-    // Get a reference to magnitude representation
-    const std::vector<uint64_t>& bit_vector = get_bit_vector();
-    bool leading = true;  // handles leading zeros
+// The cache entry for a base (2 to 36)
+static RadixPowers &radix_powers(unsigned base) {
+    // Built on first use (static initialization is thread-safe), and
+    // intentionally never destroyed
+    static RadixPowers *const table = []() {
+        RadixPowers *t = new RadixPowers[37];
+        for (unsigned b = 2; b <= 36; ++b) {
+            t[b].init(b);
+        }
+        return t;
+    }();
+    return table[base];
+}
 
-    // Iterate over the bit vector in reverse order (most significant word first)
-    for (auto it = bit_vector.rbegin(); it != bit_vector.rend(); ++it) {
-        // Skip leading zeros
-        if (leading) {
-            if (*it == 0) {
-                continue;  // Skip if current word is zero
-            } else {
-                // Once a non-zero word is found, output without padding
-                oss << std::hex << *it;
-                leading = false;  // Disable the leading zero flag
-            }
-        } else {
-            // For subsequent words, output as 16-char hexadecimal values
-            oss << std::hex << std::setw(16) << std::setfill('0') << *it;
+static bool is_power_of_two(unsigned base) {
+    return (base & (base - 1)) == 0;
+}
+
+// Append the chunks of a (n limbs) to `chunks`, least significant
+// first. Below TO_STRING_DC_THRESHOLD limbs, chunks are split off one
+// at a time by single-limb division. Above it, a is divided by the
+// largest cached big^(2^j) of at most half its size; the remainder's
+// chunks are padded to exactly 2^j so the quotient's follow them.
+static void radix_chunks(const uint64_t *a, size_t n, RadixPowers &rp,
+                         std::vector<uint64_t> &chunks) {
+    n = mpn_normalized_size(a, n);
+    if (n < BigInt::TO_STRING_DC_THRESHOLD) {
+        std::vector<uint64_t> work(a, a + n);
+        while (n > 0) {
+            chunks.push_back(mpn_divrem_1_preinv(work.data(), work.data(), n, rp.divisor));
+            n = mpn_normalized_size(work.data(), n);
         }
+        return;
     }
 
-    return oss.str();  // Return hexadecimal string
+    size_t j = 0;
+    while (2 * BigIntView(rp.level(j)).size() <= n / 2) {
+        ++j;
+    }
+    BigIntView d(rp.level(j));
+    std::vector<uint64_t> q(n - d.size() + 1), r(d.size());
+    mpn_tdiv_qr(q.data(), r.data(), a, n, d.data(), d.size());
+
+    size_t low_start = chunks.size();
+    radix_chunks(r.data(), r.size(), rp, chunks);
+    chunks.resize(low_start + (size_t(1) << j), 0);
+    radix_chunks(q.data(), q.size(), rp, chunks);
 }
 
+// The chunks of a nonzero magnitude, least significant first (the
+// last one is nonzero)
+static std::vector<uint64_t> base_chunks(const BigIntView &val, unsigned base) {
+    std::vector<uint64_t> chunks;
+    RadixPowers &rp = radix_powers(base);
+    chunks.reserve(val.size() + val.size() / 4 + 1);  // a chunk holds over 56 bits
+    radix_chunks(val.data(), val.size(), rp, chunks);
+    return chunks;
+}
 
-bool BigInt::is_zero() const {
-    return bits.empty() || (bits.size() == 1 && bits[0] == 0);
+// Number of digits in v in the given base (at least 1)
+static size_t chunk_digits(uint64_t v, unsigned base) {
+    size_t n = 1;
+    while (v >= base) {
+        v /= base;
+        ++n;
+    }
+    return n;
 }
 
-BigInt BigInt::div_by_2() const {
-    BigInt result(*this);  // Create copy of BigInt to store result
-    uint64_t carry = 0;    // holds bits carried over between words
+// Number of digits a nonzero magnitude has in the given base (for
+// bases other than powers of two, `chunks` holds its chunks)
+static size_t digit_count(const uint64_t *limbs, size_t count, unsigned base,
+                          const std::vector<uint64_t> &chunks) {
+    if (!is_power_of_two(base)) {
+        return chunk_digits(chunks.back(), base) + radix_powers(base).digits * (chunks.size() - 1);
+    }
+    size_t bits_per_digit = __builtin_ctz(base);
+    return (magnitude_bits(limbs, count) + bits_per_digit - 1) / bits_per_digit;
+}
+
+// Generate the digits of a nonzero magnitude, most significant first,
+// handing them to `sink(const char *, size_t)` a block at a time
+template <typename Sink>
+static void emit_digits(const uint64_t *limbs, size_t count, unsigned base, bool upper,
+                        const std::vector<uint64_t> &chunks, Sink &sink) {
+    const char *digit_chars = upper ? "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                                    : "0123456789abcdefghijklmnopqrstuvwxyz";
+    char block[512];
+    size_t len = 0;
+    auto put = [&](char c) {
+        if (len == sizeof(block)) {
+            sink(block, len);
+            len = 0;
+        }
+        block[len++] = c;
+    };
+
+    if (!is_power_of_two(base)) {
+        // Most significant chunk unpadded, the rest as `digits` digits each
+        unsigned digits = radix_powers(base).digits;
+        char tmp[64];
+        for (size_t i = chunks.size(); i-- > 0; ) {
+            uint64_t v = chunks[i];
+            size_t width = (i + 1 == chunks.size()) ? chunk_digits(v, base) : digits;
+            for (size_t d = width; d-- > 0; ) {
+                tmp[d] = digit_chars[v % base];
+                v /= base;
+            }
+            for (size_t d = 0; d < width; ++d) {
+                put(tmp[d]);
+            }
+        }
+    } else {
+        // Power-of-two bases read the digits straight from the limbs,
+        // which may straddle a limb boundary
+        size_t bits_per_digit = __builtin_ctz(base);
+        size_t ndigits = digit_count(limbs, count, base, chunks);
+        for (size_t d = ndigits; d-- > 0; ) {
+            size_t pos = d * bits_per_digit;
+            size_t limb = pos / 64, shift = pos % 64;
+            uint64_t v = limbs[limb] >> shift;
+            if (shift + bits_per_digit > 64 && limb + 1 < count) {
+                v |= limbs[limb + 1] << (64 - shift);
+            }
+            put(digit_chars[v & (base - 1)]);
+        }
+    }
 
-    // Iterate from the most significant word to the least significant word
-    for (size_t i = result.bits.size(); i-- > 0; ) {
-        uint64_t new_carry = result.bits[i] & 1;  // Get the least significant bit of the current word
-        result.bits[i] = (result.bits[i] >> 1) | (carry << 63);  // Shift right and add carry from the previous word
-        carry = new_carry;  // Carry over the LSB to the next word
+    if (len > 0) {
+        sink(block, len);
     }
+}
 
-    // Remove leading zero words from the result
-    while (result.bits.size() > 1 && result.bits.back() == 0) {
-        result.bits.pop_back();
+// Format a magnitude into a string, preceded by a minus sign if negative
+static std::string format_string(const BigIntView &val, unsigned base) {
+    if (val.is_zero()) {
+        return "0";
+    }
+    std::vector<uint64_t> chunks;
+    if (!is_power_of_two(base)) {
+        chunks = base_chunks(val, base);
     }
 
+    std::string result;
+    result.reserve(digit_count(val.data(), val.size(), base, chunks) + 1);
+    if (val.is_negative()) {
+        result.push_back('-');
+    }
+    auto sink = [&result](const char *s, size_t n) { result.append(s, n); };
+    emit_digits(val.data(), val.size(), base, false, chunks, sink);
     return result;
 }
 
+std::string BigIntView::to_hex() const {
+    return to_string(16);
+}
 
-std::string BigInt::to_dec() const {
-    if (is_zero()) {
-        return "0";
+std::string BigIntView::to_dec() const {
+    return to_string(10);
+}
+
+// Instrumented as to_hex when digits are read from the bits, and as
+// to_dec when they take divisions
+std::string BigIntView::to_string(unsigned base) const {
+    check_base(base);
+    BIGINT_OP_SCOPE(is_power_of_two(base) ? BigIntOp::TO_HEX : BigIntOp::TO_DEC, size());
+    return format_string(*this, base);
+}
+
+// Value of a digit character in the given base, or -1 if it is not one
+static int digit_value(char c, unsigned base) {
+    int v = -1;
+    if (c >= '0' && c <= '9') {
+        v = c - '0';
+    } else if (c >= 'a' && c <= 'z') {
+        v = c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'Z') {
+        v = c - 'A' + 10;
     }
+    return v < static_cast<int>(base) ? v : -1;
+}
 
-    BigInt value = *this;  // Copy of BigInt 
-    value.negative = false;  // Work with the abs value
+// Value of n chunks (least significant first): by Horner's rule below
+// FROM_STRING_DC_THRESHOLD chunks, otherwise the high part times
+// big^(2^j) plus the low 2^j chunks, with each part computed recursively
+static BigInt combine_chunks(const uint64_t *chunks, size_t n, RadixPowers &rp) {
+    if (n < BigInt::FROM_STRING_DC_THRESHOLD) {
+        // The value is below big^n, so it fits in n limbs
+        std::vector<uint64_t> r(n, 0);
+        for (size_t used = 0, i = n; i-- > 0; ++used) {
+            uint64_t top = mpn_mul_1(r.data(), r.data(), used, rp.big);
+            top += mpn_add_1(r.data(), r.data(), used, chunks[i]);
+            r[used] = top;
+        }
+        return BigIntView(r.data(), n).to_bigint();
+    }
 
-    std::stringstream ss;
-    if (is_negative()) {
-        ss << "-";
+    size_t j = 0;
+    while ((size_t(2) << j) < n) {
+        ++j;
     }
+    size_t low = size_t(1) << j;
+    return fma(combine_chunks(chunks + low, n - low, rp), rp.level(j),
+               combine_chunks(chunks, low, rp));
+}
 
-    // Vector to store digits in reverse order
-    std::vector<char> digits;
+BigInt BigInt::from_string(const std::string &str, unsigned base) {
+    check_base(base);
 
-    // BigInt for 10 (divisor)
-    BigInt ten(10, false);
+    size_t start = 0;
+    bool negative = false;
+    if (!str.empty() && (str[0] == '-' || str[0] == '+')) {
+        negative = (str[0] == '-');
+        start = 1;
+    }
+    size_t ndigits = str.size() - start;
+    if (ndigits == 0) {
+        throw std::invalid_argument("No digits to parse");
+    }
+    for (size_t i = start; i < str.size(); ++i) {
+        if (digit_value(str[i], base) < 0) {
+            throw std::invalid_argument("Invalid digit in BigInt string");
+        }
+    }
 
-    while (!value.is_zero()) {
-        // Get the quotient and remainder 
-        BigInt quotient = value / ten;
-        BigInt remainder = value - (quotient * ten);  // remainder = value % 10
-        digits.push_back(static_cast<char>(remainder.get_bits(0) + '0'));  // Store digit as a char
-        value = quotient;  // Update value to the quotient for next iteration
+    if (is_power_of_two(base)) {
+        // Pack the digits' bits straight into limbs, least significant first
+        size_t bits_per_digit = __builtin_ctz(base);
+        std::vector<uint64_t> limbs((ndigits * bits_per_digit + 63) / 64, 0);
+        for (size_t d = 0; d < ndigits; ++d) {
+            uint64_t v = digit_value(str[str.size() - 1 - d], base);
+            size_t pos = d * bits_per_digit;
+            limbs[pos / 64] |= v << (pos % 64);
+            if (pos % 64 + bits_per_digit > 64) {
+                limbs[pos / 64 + 1] |= v >> (64 - pos % 64);
+            }
+        }
+        return BigInt(std::move(limbs), negative);
     }
 
-    // Reverse collected digits
-    for (auto it = digits.rbegin(); it != digits.rend(); ++it) {
-        ss << *it;
+    // Split into chunks from the least significant end; the most
+    // significant chunk may be short
+    RadixPowers &rp = radix_powers(base);
+    std::vector<uint64_t> chunks((ndigits + rp.digits - 1) / rp.digits);
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        size_t end = str.size() - c * rp.digits;
+        size_t begin = (end - start > rp.digits) ? end - rp.digits : start;
+        uint64_t v = 0;
+        for (size_t i = begin; i < end; ++i) {
+            v = v * base + digit_value(str[i], base);
+        }
+        chunks[c] = v;
     }
 
-    return ss.str();
+    BigInt result = combine_chunks(chunks.data(), chunks.size(), rp);
+    return negative ? -result : result;
 }
 
+std::ostream &operator<<(std::ostream &os, const BigIntView &val) {
+    // Like any formatted output: nothing is written to a failed stream,
+    // and a tied stream is flushed first
+    std::ostream::sentry sentry(os);
+    if (!sentry) {
+        return os;
+    }
+
+    std::ios_base::fmtflags flags = os.flags();
+    unsigned base = 10;
+    if ((flags & std::ios_base::basefield) == std::ios_base::hex) {
+        base = 16;
+    } else if ((flags & std::ios_base::basefield) == std::ios_base::oct) {
+        base = 8;
+    }
+    BIGINT_OP_SCOPE(base == 10 ? BigIntOp::TO_DEC : BigIntOp::TO_HEX, val.size());
 
+    std::vector<uint64_t> chunks;
+    if (base == 10 && !val.is_zero()) {
+        chunks = base_chunks(val, 10);
+    }
+
+    // Sign and base prefix, as for built-in integers
+    std::string prefix;
+    if (val.is_negative()) {
+        prefix = "-";
+    } else if ((flags & std::ios_base::showpos) && base == 10) {
+        prefix = "+";
+    }
+    if ((flags & std::ios_base::showbase) && !val.is_zero()) {
+        if (base == 16) {
+            prefix += (flags & std::ios_base::uppercase) ? "0X" : "0x";
+        } else if (base == 8) {
+            prefix += "0";
+        }
+    }
 
+    size_t ndigits = val.is_zero() ? 1 : digit_count(val.data(), val.size(), base, chunks);
+    size_t len = prefix.size() + ndigits;
+    size_t width = os.width() > 0 ? static_cast<size_t>(os.width()) : 0;
+    size_t pad = width > len ? width - len : 0;
+    os.width(0);
+
+    std::ios_base::fmtflags adjust = flags & std::ios_base::adjustfield;
+    auto write_padding = [&os, pad]() {
+        for (size_t i = 0; i < pad; ++i) {
+            os.put(os.fill());
+        }
+    };
+
+    if (adjust != std::ios_base::left && adjust != std::ios_base::internal) {
+        write_padding();
+    }
+    os.write(prefix.data(), prefix.size());
+    if (adjust == std::ios_base::internal) {
+        write_padding();
+    }
+    if (val.is_zero()) {
+        os.put('0');
+    } else {
+        auto sink = [&os](const char *s, size_t n) { os.write(s, n); };
+        emit_digits(val.data(), val.size(), base, (flags & std::ios_base::uppercase) != 0, chunks, sink);
+    }
+    if (adjust == std::ios_base::left) {
+        write_padding();
+    }
+    return os;
+}
+
+std::ostream &operator<<(std::ostream &os, const BigInt &val) {
+    return os << BigIntView(val);
+}
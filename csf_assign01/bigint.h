@@ -3,22 +3,102 @@
 #define BIGINT_H
 
 #include <initializer_list>
+#include <iosfwd>
 #include <vector>
+#include <memory>
 #include <string>
 #include <cstdint>
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <type_traits>
+#include "bigint_mpn.h"
+
+// Crossover points measured on this machine by "make tune" (see
+// bigint_tune.cpp), if it has been run; the defaults below otherwise
+#if defined(__has_include)
+#if __has_include("bigint_thresholds.h")
+#include "bigint_thresholds.h"
+#endif
+#endif
+
+#ifndef BIGINT_KARATSUBA_THRESHOLD
+#define BIGINT_KARATSUBA_THRESHOLD 32
+#endif
+#ifndef BIGINT_PARALLEL_MUL_THRESHOLD
+#define BIGINT_PARALLEL_MUL_THRESHOLD 16384
+#endif
+#ifndef BIGINT_TO_STRING_DC_THRESHOLD
+#define BIGINT_TO_STRING_DC_THRESHOLD 32
+#endif
+#ifndef BIGINT_FROM_STRING_DC_THRESHOLD
+#define BIGINT_FROM_STRING_DC_THRESHOLD 32
+#endif
+
+// bigint_tune builds the library (with -DBIGINT_TUNE) with adjustable
+// thresholds, so it can time the algorithms on either side of each one
+#ifdef BIGINT_TUNE
+#define BIGINT_THRESHOLD(name, value) static size_t name
+#else
+#define BIGINT_THRESHOLD(name, value) static const size_t name = value
+#endif
 
 //! @file
 //! Arbitrary-precision integer data type.
 
+class BigIntView;
+
+// Enables the mixed BigInt/machine word overloads for integral types
+// other than bool
+template <typename T>
+using EnableIfWord = typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type;
+
+// int64_t or uint64_t, whichever has the signedness of T
+template <typename T>
+using WideWord = typename std::conditional<std::is_signed<T>::value, int64_t, uint64_t>::type;
+
 //! Class representing an arbitrary-precision integer represented as a bit string
 //! (implemented using a vector of `uint64_t` elements) and a boolean flag
 //! to record whether or not the value is negative.
+//!
+//! The bit string is held in reference-counted copy-on-write storage:
+//! copying a BigInt (and sign-only changes such as negation) only
+//! shares the storage, which is copied the first time one of the
+//! values sharing it is modified. The reference count is atomic, so
+//! many threads may copy the same (const) BigInt concurrently.
+//!
+//! The number of significant limbs is kept in an explicit length
+//! field, and every operation trims the storage to it as it finishes
+//! (shrinking keeps the capacity, so in-place accumulation reuses it).
 class BigInt {
 private:
-   std::vector<uint64_t> bits;
+   std::shared_ptr<std::vector<uint64_t>> bits;  // shared copy-on-write
+   size_t len;     // number of significant limbs (0 for zero); bits holds max(len, 1)
    bool negative;
-   BigInt div_by_2() const;
-   BigInt binary_search_quotient(const BigInt &dividend, const BigInt &divisor) const;
+
+   // Construct from an already-computed magnitude, which may have
+   // leading zero limbs (they are trimmed off), and a zero magnitude
+   // is never negative
+   BigInt(std::vector<uint64_t> &&bits, bool negative);
+
+   // Single-limb kernels for the mixed BigInt/machine word operators:
+   // a + b and a * b for a word b of magnitude `b` and sign `b_negative`
+   static BigInt add_word(const BigIntView &a, uint64_t b, bool b_negative);
+   static BigInt mul_word(const BigIntView &a, uint64_t b, bool b_negative);
+
+   // *this += a * b (or -= if `subtract`), in place in this value's limbs
+   void add_product(const BigIntView &a, const BigIntView &b, bool subtract);
+
+   // Writable access to the bit string, first detaching it from any
+   // other BigInt values that share it
+   std::vector<uint64_t> &mutable_bits();
+
+   friend class BigIntView;
+   friend std::pair<BigInt, uint64_t> divrem(const BigInt &dividend, uint64_t divisor);
+
+   friend void addmul(BigInt &acc, const BigIntView &a, const BigIntView &b);
+   friend void submul(BigInt &acc, const BigIntView &a, const BigIntView &b);
    
 public:
    bool is_zero() const;
@@ -44,7 +124,8 @@ public:
   //! @param negative if true, the value is negative
   BigInt(uint64_t val, bool negative = false);
 
-  //! Copy constructor.
+  //! Copy constructor. Takes constant time: the copy shares `other`'s
+  //! bit string until either value is modified.
   //!
   //! @param other another BigInt object that this object should be made
   //!              identical to
@@ -53,7 +134,8 @@ public:
   //! Destructor.
   ~BigInt();
 
-  //! Assignment operator.
+  //! Assignment operator. Takes constant time, sharing `rhs`'s bit
+  //! string as the copy constructor does.
   //!
   //! @param rhs another BigInt object that this object should be made
   //!            identical to
@@ -85,6 +167,9 @@ public:
   //! all you should need to do is return a reference to the
   //! internal vector the BigInt object keeps its magnitude bits in.
   //!
+  //! The first call after an operation that left leading zero limbs
+  //! in the storage trims them (without reallocating).
+  //!
   //! @return const reference to the vector containing the bit string values
   //!         (element at index has the least-significant 64 bits, etc.)
   const std::vector<uint64_t> &get_bit_vector() const;
@@ -96,6 +181,12 @@ public:
   //! @return the BigInt value representing the sum of the operands
   BigInt operator+(const BigInt &rhs) const;
 
+  //! Addition operator taking a non-owning view as the right-hand side.
+  //!
+  //! @param rhs the right-hand side value
+  //! @return the BigInt value representing the sum of the operands
+  BigInt operator+(const BigIntView &rhs) const;
+
   //! Subtraction operator.
   //!
   //! @param rhs the right-hand side BigInt value (the left hand value
@@ -103,6 +194,12 @@ public:
   //! @return the BigInt value representing the difference of the operands
   BigInt operator-(const BigInt &rhs) const;
 
+  //! Subtraction operator taking a non-owning view as the right-hand side.
+  //!
+  //! @param rhs the right-hand side value
+  //! @return the BigInt value representing the difference of the operands
+  BigInt operator-(const BigIntView &rhs) const;
+
   //! Unary negation operator.
   //!
   //! @return the BigInt value representing the negation of this
@@ -115,6 +212,38 @@ public:
   //! @return true if bit `n` is set to 1, false if it is set to 0
   bool is_bit_set(unsigned n) const;
 
+  //! @return the number of bits in the magnitude, not counting
+  //!         leading zeros (0 for zero)
+  size_t bit_length() const;
+
+  //! @return the number of trailing zero bits in the magnitude (the
+  //!         index of the lowest set bit), or 0 for zero
+  size_t countr_zero() const;
+
+  //! @return the number of bits set to 1 in the magnitude
+  size_t popcount() const;
+
+  //! Extract a field of the magnitude: bits `pos` to `pos + width - 1`,
+  //! shifted down to bit 0. Bits beyond the magnitude read as 0.
+  //!
+  //! @param pos the lowest bit of the field
+  //! @param width the width of the field (at most 64)
+  //! @return the field's value
+  //! @throw std::invalid_argument if `width` is greater than 64
+  uint64_t extract_bits(size_t pos, unsigned width) const;
+
+  //! Set a bit of the magnitude to 1, growing it as needed. The sign
+  //! is unchanged (except that a zero value becomes positive).
+  //!
+  //! @param n the bit to set (0 for the least significant bit, etc.)
+  void set_bit(size_t n);
+
+  //! Clear a bit of the magnitude to 0. The sign is unchanged, unless
+  //! the value becomes zero.
+  //!
+  //! @param n the bit to clear (0 for the least significant bit, etc.)
+  void clear_bit(size_t n);
+
   //! Left shift by n bits. Note that it is only allowed
   //! to use this operation on non-negative values.
   //! An `std::invalid_argument` exception is thrown if
@@ -126,6 +255,16 @@ public:
   //! @throw std::invalid_argument if this object represents a negative value
   BigInt operator<<(unsigned n) const;
 
+  //! Right shift by n bits (the magnitude is divided by 2^n,
+  //! truncating). Like left shift, it is only allowed on non-negative
+  //! values.
+  //!
+  //! @param n number of bits to shift right by
+  //! @return BigInt value representing the result of shifting this
+  //!         value right by `n` bits
+  //! @throw std::invalid_argument if this object represents a negative value
+  BigInt operator>>(unsigned n) const;
+
   //! Multiplication operator.
   //!
   //! @param rhs the right-hand side BigInt value (the left hand value
@@ -133,6 +272,12 @@ public:
   //! @return the BigInt value representing the product of the operands
   BigInt operator*(const BigInt &rhs) const;
 
+  //! Multiplication operator taking a non-owning view as the right-hand side.
+  //!
+  //! @param rhs the right-hand side value
+  //! @return the BigInt value representing the product of the operands
+  BigInt operator*(const BigIntView &rhs) const;
+
   //! Division operator.
   //! Note that since BigInt objects represent integers, this
   //! operator should return a quotient value with the largest
@@ -155,6 +300,47 @@ public:
   //!        equal to 0
   BigInt operator/(const BigInt &rhs) const;
 
+  //! Remainder operator. The remainder matches the rounding of `/`:
+  //! it is zero or has the sign of the left-hand value (as for
+  //! built-in integers), so `(a / b) * b + a % b == a`.
+  //!
+  //! @param rhs the right-hand side BigInt value (the divisor)
+  //! @return the remainder of dividing the left hand BigInt by `rhs`
+  //! @throw std::invalid_argument if `rhs` is equal to 0
+  BigInt operator%(const BigInt &rhs) const;
+
+  //! Arithmetic with a machine word. These work on the limbs directly
+  //! with single-limb kernels (`/` and `%` with a precomputed
+  //! reciprocal), without first building a BigInt for the word.
+  //! Division and remainder round as for BigInt operands. Other
+  //! integral types (e.g., `int` literals, as in `x + 1`) are widened
+  //! to `int64_t` or `uint64_t`.
+  //!
+  //! @param rhs the right-hand side value
+  //! @return the result of the operation
+  //! @throw std::invalid_argument if `/` or `%` is given a 0 divisor
+  BigInt operator+(uint64_t rhs) const;
+  BigInt operator+(int64_t rhs) const;
+  BigInt operator-(uint64_t rhs) const;
+  BigInt operator-(int64_t rhs) const;
+  BigInt operator*(uint64_t rhs) const;
+  BigInt operator*(int64_t rhs) const;
+  BigInt operator/(uint64_t rhs) const;
+  BigInt operator/(int64_t rhs) const;
+  BigInt operator%(uint64_t rhs) const;
+  BigInt operator%(int64_t rhs) const;
+
+  template <typename T, EnableIfWord<T> = 0>
+  BigInt operator+(T rhs) const { return *this + static_cast<WideWord<T>>(rhs); }
+  template <typename T, EnableIfWord<T> = 0>
+  BigInt operator-(T rhs) const { return *this - static_cast<WideWord<T>>(rhs); }
+  template <typename T, EnableIfWord<T> = 0>
+  BigInt operator*(T rhs) const { return *this * static_cast<WideWord<T>>(rhs); }
+  template <typename T, EnableIfWord<T> = 0>
+  BigInt operator/(T rhs) const { return *this / static_cast<WideWord<T>>(rhs); }
+  template <typename T, EnableIfWord<T> = 0>
+  BigInt operator%(T rhs) const { return *this % static_cast<WideWord<T>>(rhs); }
+
   //! Compare two BigInt values, returning
   //!   - negative if lhs < rhs
   //!   - 0 if lhs = rhs
@@ -166,6 +352,25 @@ public:
   //!         0 means equal, positive means greater)
   int compare(const BigInt &rhs) const;
 
+  //! Compare this value with a non-owning view (see `compare(const BigInt &)`).
+  //!
+  //! @param rhs the right-hand side value
+  //! @return negative, 0, or positive as this value is less than,
+  //!         equal to, or greater than `rhs`
+  int compare(const BigIntView &rhs) const;
+
+  //! Compare this value with a machine word, without building a BigInt
+  //! for it (other integral types are widened as for arithmetic).
+  //!
+  //! @param rhs the right-hand side value
+  //! @return negative, 0, or positive as this value is less than,
+  //!         equal to, or greater than `rhs`
+  int compare(uint64_t rhs) const;
+  int compare(int64_t rhs) const;
+
+  template <typename T, EnableIfWord<T> = 0>
+  int compare(T rhs) const { return compare(static_cast<WideWord<T>>(rhs)); }
+
   // comparison operators: you won't need to modify these,
   // since they're all implemented using compare
   bool operator==(const BigInt &rhs) const { return compare(rhs) == 0; }
@@ -175,6 +380,26 @@ public:
   bool operator>(const BigInt &rhs) const  { return compare(rhs) > 0; }
   bool operator>=(const BigInt &rhs) const { return compare(rhs) >= 0; }
 
+  bool operator==(const BigIntView &rhs) const { return compare(rhs) == 0; }
+  bool operator!=(const BigIntView &rhs) const { return compare(rhs) != 0; }
+  bool operator<(const BigIntView &rhs) const  { return compare(rhs) < 0; }
+  bool operator<=(const BigIntView &rhs) const { return compare(rhs) <= 0; }
+  bool operator>(const BigIntView &rhs) const  { return compare(rhs) > 0; }
+  bool operator>=(const BigIntView &rhs) const { return compare(rhs) >= 0; }
+
+  template <typename T, EnableIfWord<T> = 0>
+  bool operator==(T rhs) const { return compare(rhs) == 0; }
+  template <typename T, EnableIfWord<T> = 0>
+  bool operator!=(T rhs) const { return compare(rhs) != 0; }
+  template <typename T, EnableIfWord<T> = 0>
+  bool operator<(T rhs) const  { return compare(rhs) < 0; }
+  template <typename T, EnableIfWord<T> = 0>
+  bool operator<=(T rhs) const { return compare(rhs) <= 0; }
+  template <typename T, EnableIfWord<T> = 0>
+  bool operator>(T rhs) const  { return compare(rhs) > 0; }
+  template <typename T, EnableIfWord<T> = 0>
+  bool operator>=(T rhs) const { return compare(rhs) >= 0; }
+
   //! Return a string representing the value of this BigInt, in
   //! lower-case hexadecimal (base-16). Note that there should be a leading
   //! minus sign (`-`) if this value is negative.
@@ -189,82 +414,438 @@ public:
   //! @return the value of this BigInt object in decimal (base-10)
   std::string to_dec() const;
 
-private:
+  //! Return a string representing the value of this BigInt in any
+  //! base from 2 to 36, with digits `0`-`9` followed by lower-case
+  //! letters, and a leading minus sign (`-`) if this value is
+  //! negative. Values of `TO_STRING_DC_THRESHOLD` limbs or more are split in
+  //! two by a cached power of the base (see `from_string`), and each
+  //! part is converted recursively.
+  //!
+  //! @param base the base (2 to 36)
+  //! @return the value of this BigInt object in the given base
+  //! @throw std::invalid_argument if `base` is out of range
+  std::string to_string(unsigned base = 10) const;
+
+  //! Parse a string of digits in any base from 2 to 36 (letters in
+  //! either case), with an optional leading `-` or `+`. Strings of
+  //! `FROM_STRING_DC_THRESHOLD` chunks (see below) or more are parsed
+  //! by divide and conquer: each half is parsed separately, and the
+  //! halves are joined with a multiply-add by a power of the base.
+  //!
+  //! The powers (B, B^2, B^4, ..., where B = base^k is the largest
+  //! power of the base that fits in a limb) live in a process-wide
+  //! cache shared by parsing, `to_string`, `to_dec` and stream output.
+  //! The cache grows on first use of each power, under a lock, and is
+  //! read without locking from then on. Converting many values of
+  //! similar size therefore computes each power only once.
+  //!
+  //! @param str the digits
+  //! @param base the base (2 to 36)
+  //! @return the value
+  //! @throw std::invalid_argument if `base` is out of range, or `str`
+  //!        has no digits or a character that is not a digit in `base`
+  static BigInt from_string(const std::string &str, unsigned base = 10);
+
+  //! Number of bytes `serialize` writes for this value: one 8-byte
+  //! header word plus 8 bytes per limb.
+  //!
+  //! @return the size of the fixed-layout serialized form in bytes
+  size_t serialized_size() const;
+
+  //! Write this value in the fixed little-endian limb format: a
+  //! little-endian `uint64_t` header holding `(limb count << 1) | sign`,
+  //! followed by the limbs as little-endian `uint64_t` values, least
+  //! significant first. If `buf` is 8-byte aligned, the limbs can later
+  //! be used in place via `deserialize_view`.
+  //!
+  //! @param buf destination with room for `serialized_size()` bytes
+  void serialize(uint8_t *buf) const;
+
+  //! Serialize into a new byte vector (see `serialize(uint8_t *)`).
+  //!
+  //! @return the fixed-layout serialized form
+  std::vector<uint8_t> serialize() const;
+
+  //! Read a value written by `serialize`, copying the limbs.
+  //!
+  //! @param buf pointer to the serialized data
+  //! @param len number of bytes available at `buf`
+  //! @return the deserialized value
+  //! @throw std::invalid_argument if the data is truncated
+  static BigInt deserialize(const uint8_t *buf, size_t len);
+
+  //! Zero-copy version of `deserialize`: returns a view whose limbs
+  //! point directly into `buf` (e.g., an mmap'd file), which must
+  //! outlive the view.
+  //!
+  //! @param buf pointer to the serialized data (must be 8-byte aligned)
+  //! @param len number of bytes available at `buf`
+  //! @return a view of the serialized value
+  //! @throw std::invalid_argument if the data is truncated or misaligned,
+  //!        or if the host is not little-endian
+  static BigIntView deserialize_view(const uint8_t *buf, size_t len);
+
+  //! Compact variable-length encoding for interchange: a LEB128
+  //! header holding `(magnitude byte count << 1) | sign`, followed by
+  //! the magnitude as big-endian bytes with no leading zero bytes
+  //! (zero has no magnitude bytes).
+  //!
+  //! @return the encoded bytes
+  std::vector<uint8_t> to_bytes() const;
 
-static int compare_magnitudes(const BigInt &lhs, const BigInt &rhs) {
-    const std::vector<uint64_t>& lhs_bits = lhs.get_bit_vector();
-    const std::vector<uint64_t>& rhs_bits = rhs.get_bit_vector();
+  //! Decode a value written by `to_bytes`.
+  //!
+  //! @param buf pointer to the encoded data
+  //! @param len number of bytes available at `buf`
+  //! @param consumed if non-null, receives the number of bytes used
+  //!        (so several values can be read back to back)
+  //! @return the decoded value
+  //! @throw std::invalid_argument if the data is truncated or malformed
+  static BigInt from_bytes(const uint8_t *buf, size_t len, size_t *consumed = nullptr);
+
+  //! Convert to the nearest `double`, rounding ties to even; values
+  //! too large for a `double` become infinity (of the same sign).
+  //! Only the top limbs are read, except to break an exact tie.
+  //!
+  //! @return the value as a `double`
+  double to_double() const;
 
-    if (lhs_bits.size() > rhs_bits.size()) {
-        return 1;
+  //! Convert to the nearest `long double` (see `to_double`).
+  //!
+  //! @return the value as a `long double`
+  long double to_long_double() const;
+
+  //! Convert a `double` to a BigInt, discarding any fractional part
+  //! (rounding toward zero, as a cast to an integer type does).
+  //!
+  //! @param d the value to convert
+  //! @return the integer part of `d`
+  //! @throw std::invalid_argument if `d` is infinite or NaN
+  static BigInt from_double(double d);
+
+  //! Convert a `long double` to a BigInt (see `from_double`).
+  //!
+  //! @param d the value to convert
+  //! @return the integer part of `d`
+  //! @throw std::invalid_argument if `d` is infinite or NaN
+  static BigInt from_long_double(long double d);
+
+  //! Approximate base-2 logarithm of the magnitude, from its bit
+  //! length and top limbs (so it is cheap even for huge values, and
+  //! accurate to about `double` precision).
+  //!
+  //! @return log2(|value|), or minus infinity for zero
+  double log2_approx() const;
+
+  //! Generate a uniformly distributed random value in [0, 2^n),
+  //! filling whole limbs directly from a random engine.
+  //!
+  //! @param n number of random bits
+  //! @param rng a uniform random bit generator (e.g., `std::mt19937_64`)
+  //! @return the random (non-negative) value
+  template <typename Rng>
+  static BigInt random_bits(unsigned n, Rng &rng);
+
+  //! Generate a uniformly distributed random value in [0, bound),
+  //! by rejection sampling of values with as many bits as `bound`
+  //! (fewer than two draws on average).
+  //!
+  //! @param bound the exclusive upper bound
+  //! @param rng a uniform random bit generator (e.g., `std::mt19937_64`)
+  //! @return the random (non-negative) value
+  //! @throw std::invalid_argument if `bound` is not positive
+  template <typename Rng>
+  static BigInt random_below(const BigInt &bound, Rng &rng);
+
+  //! Set the maximum number of threads a single multiplication may
+  //! use. Products of operands with fewer than
+  //! `PARALLEL_MUL_THRESHOLD` limbs always run on the calling thread;
+  //! above that, Karatsuba subproducts are handed to worker threads
+  //! as long as the thread budget allows. The same budget (see
+  //! `ThreadSlot`) covers the workers of `product` and `factorial`, so
+  //! the cap holds for them too, including their inner multiplications.
+  //!
+  //! @param n the maximum number of threads (0 restores the default,
+  //!          which is the number of hardware threads)
+  static void set_max_threads(unsigned n);
+
+  //! Get the maximum number of threads a single multiplication may use.
+  //!
+  //! @return the current thread cap (always at least 1)
+  static unsigned get_max_threads();
+
+  //! A worker thread reserved from the process-wide budget that
+  //! `set_max_threads` caps, shared by parallel multiplication and the
+  //! product tree of `product`. Code that starts a thread for BigInt
+  //! work acquires a slot first, and the slot gives the reservation
+  //! back when released or destroyed (so also when an exception
+  //! unwinds past it). Declare the slot before the `std::future` of
+  //! its task, so it outlives the future's wait for the task.
+  class ThreadSlot {
+  private:
+     bool held;
+
+  public:
+    ThreadSlot() : held(false) {}
+    ~ThreadSlot() { release(); }
+    ThreadSlot(const ThreadSlot &) = delete;
+    ThreadSlot &operator=(const ThreadSlot &) = delete;
+
+    //! Try to reserve a worker thread. The calling thread counts
+    //! against the cap, so a cap of 1 never grants one.
+    //!
+    //! @return true if a thread was reserved
+    bool acquire();
+
+    //! Give the reserved thread back (if there is one).
+    void release();
+  };
+
+  //! Operand size (in limbs) below which multiplication uses the
+  //! schoolbook algorithm instead of Karatsuba (32 unless tuned).
+  BIGINT_THRESHOLD(KARATSUBA_THRESHOLD, BIGINT_KARATSUBA_THRESHOLD);
+
+  //! Operand size (in limbs) at or above which Karatsuba subproducts
+  //! are computed in parallel (16384 limbs, about one million bits,
+  //! unless tuned).
+  BIGINT_THRESHOLD(PARALLEL_MUL_THRESHOLD, BIGINT_PARALLEL_MUL_THRESHOLD);
+
+  //! Value size (in limbs) below which `to_string` in bases other than
+  //! powers of two splits off one limb's worth of digits at a time
+  //! instead of dividing and conquering (32 unless tuned).
+  BIGINT_THRESHOLD(TO_STRING_DC_THRESHOLD, BIGINT_TO_STRING_DC_THRESHOLD);
+
+  //! String size (in chunks of k digits, for the largest base^k that
+  //! fits in a limb, e.g. 19 decimal digits) below which `from_string`
+  //! in bases other than powers of two combines the chunks one at a
+  //! time instead of dividing and conquering (32 unless tuned). As
+  //! the two directions cost differently, each has its own threshold.
+  BIGINT_THRESHOLD(FROM_STRING_DC_THRESHOLD, BIGINT_FROM_STRING_DC_THRESHOLD);
+
+private:
+
+// Fill limbs with random bits, keeping only the low `n` bits overall
+template <typename Rng>
+static void fill_random(std::vector<uint64_t> &limbs, unsigned n, Rng &rng) {
+    std::uniform_int_distribution<uint64_t> dist;
+    for (uint64_t &limb : limbs) {
+        limb = dist(rng);
     }
-    if (lhs_bits.size() < rhs_bits.size()) {
-        return -1;
+    if (n % 64 != 0) {
+        limbs.back() &= (uint64_t(1) << (n % 64)) - 1;
     }
+}
 
-    for (size_t i = lhs_bits.size(); i-- > 0; ) {
-        if (lhs_bits[i] > rhs_bits[i]) {
-            return 1;
-        }
-        if (lhs_bits[i] < rhs_bits[i]) {
-            return -1;
-        }
-    }
+};
 
-    return 0;
-}
+//! Class representing a non-owning, read-only view of an
+//! arbitrary-precision integer whose limbs live in memory owned by
+//! someone else (another BigInt, an mmap'd file, a network buffer,
+//! etc.). The limbs are `uint64_t` values in "little endian" order,
+//! exactly as in `BigInt::get_bit_vector()`. The viewed memory must
+//! outlive the view and must not change while the view is in use.
+//!
+//! Every BigInt converts implicitly to a BigIntView, so views can be
+//! mixed freely with BigInt values in comparisons and in `+`, `-`
+//! and `*`; results are always new BigInt values.
+class BigIntView {
+private:
+   const uint64_t *limbs;
+   size_t count;
+   bool negative;
 
-static std::vector<uint64_t>  add_magnitudes(const BigInt &lhs, const BigInt &rhs) {
-    const std::vector<uint64_t>& lhs_bits = lhs.get_bit_vector();
-    const std::vector<uint64_t>& rhs_bits = rhs.get_bit_vector();
+public:
+  //! Constructor from a pointer to limbs, a limb count, and (optionally)
+  //! a sign. Leading zero limbs are ignored.
+  //!
+  //! @param limbs pointer to `count` limbs, least significant first
+  //! @param count number of limbs
+  //! @param negative if true, the value is negative
+  BigIntView(const uint64_t *limbs, size_t count, bool negative = false);
 
-    size_t max_size = std::max(lhs_bits.size(), rhs_bits.size());
-    std::vector<uint64_t> result_bits(max_size, 0);
+  //! Constructor viewing the magnitude and sign of a BigInt.
+  //!
+  //! @param val the BigInt to view (must outlive the view)
+  BigIntView(const BigInt &val);
 
-    uint64_t carry = 0;
+  //! @return pointer to the limbs (least significant first)
+  const uint64_t *data() const { return limbs; }
 
-    for (size_t i = 0; i < max_size; ++i) {
-        uint64_t lhs_val = (i < lhs_bits.size()) ? lhs_bits[i] : 0;
-        uint64_t rhs_val = (i < rhs_bits.size()) ? rhs_bits[i] : 0;
+  //! @return number of limbs, not counting leading zero limbs
+  //!         (0 if the value is zero)
+  size_t size() const { return count; }
 
-        uint64_t sum = lhs_val + rhs_val + carry;
-        carry = (sum < lhs_val || sum < rhs_val) ? 1 : 0;
-        result_bits[i] = sum;
-    }
+  //! @return true if the value is negative, false otherwise
+  bool is_negative() const { return negative; }
 
-    if (carry > 0) {
-        result_bits.push_back(carry);
-    }
+  //! @return true if the value is zero, false otherwise
+  bool is_zero() const { return count == 0; }
 
-    return result_bits;
-}
+  //! Get one `uint64_t` chunk of the viewed bit string (0 if `index`
+  //! is past the most significant limb).
+  //!
+  //! @param index the index of the limb to retrieve
+  //! @return the limb value
+  uint64_t get_bits(size_t index) const { return index < count ? limbs[index] : 0; }
 
-static std::vector<uint64_t>  subtract_magnitudes(const BigInt &lhs, const BigInt &rhs) {
-    const std::vector<uint64_t>& lhs_bits = lhs.get_bit_vector();
-    const std::vector<uint64_t>& rhs_bits = rhs.get_bit_vector();
+  //! Make an owning copy of the viewed value.
+  //!
+  //! @return a BigInt with the same value
+  BigInt to_bigint() const;
 
-    size_t max_size = std::max(lhs_bits.size(), rhs_bits.size());
-    std::vector<uint64_t> result_bits(max_size, 0);
+  //! Negation without copying: a view of the same limbs with the
+  //! opposite sign (zero stays non-negative).
+  //!
+  //! @return the negated view
+  BigIntView operator-() const;
 
-    uint64_t borrow = 0;
+  //! @param rhs the right-hand side value
+  //! @return the sum of the operands
+  BigInt operator+(const BigIntView &rhs) const;
 
-    for (size_t i = 0; i < max_size; ++i) {
-        uint64_t lhs_val = (i < lhs_bits.size()) ? lhs_bits[i] : 0;
-        uint64_t rhs_val = (i < rhs_bits.size()) ? rhs_bits[i] : 0;
+  //! @param rhs the right-hand side value
+  //! @return the difference of the operands
+  BigInt operator-(const BigIntView &rhs) const;
 
-        uint64_t diff = lhs_val - rhs_val - borrow;
-        borrow = (lhs_val < rhs_val + borrow) ? 1 : 0;
-        result_bits[i] = diff;
-    }
+  //! @param rhs the right-hand side value
+  //! @return the product of the operands
+  BigInt operator*(const BigIntView &rhs) const;
 
-    while (result_bits.size() > 1 && result_bits.back() == 0) {
-        result_bits.pop_back();
-    }
+  //! Compare two values (see `BigInt::compare`).
+  //!
+  //! @param rhs the right-hand side value
+  //! @return negative, 0, or positive as this value is less than,
+  //!         equal to, or greater than `rhs`
+  int compare(const BigIntView &rhs) const;
+
+  bool operator==(const BigIntView &rhs) const { return compare(rhs) == 0; }
+  bool operator!=(const BigIntView &rhs) const { return compare(rhs) != 0; }
+  bool operator<(const BigIntView &rhs) const  { return compare(rhs) < 0; }
+  bool operator<=(const BigIntView &rhs) const { return compare(rhs) <= 0; }
+  bool operator>(const BigIntView &rhs) const  { return compare(rhs) > 0; }
+  bool operator>=(const BigIntView &rhs) const { return compare(rhs) >= 0; }
+
+  //! @return the value in lower-case hexadecimal (see `BigInt::to_hex`)
+  std::string to_hex() const;
+
+  //! @return the value in decimal (see `BigInt::to_dec`)
+  std::string to_dec() const;
+
+  //! @param base the base (2 to 36)
+  //! @return the value in the given base (see `BigInt::to_string`)
+  //! @throw std::invalid_argument if `base` is out of range
+  std::string to_string(unsigned base = 10) const;
+};
 
-    return result_bits;
+//! Write a value to an output stream, in the base selected by the
+//! stream's `basefield` flags (`std::dec`, `std::hex` or `std::oct`).
+//! `std::showbase`, `std::showpos`, `std::uppercase`, the field width
+//! and `std::left`/`std::internal` adjustment are honored as for
+//! built-in integers. Digits are generated and written in fixed-size
+//! blocks, so the full string is never materialized; for decimal
+//! output, the only working storage is the value's base-10^19 digits
+//! (about the size of the value itself).
+//!
+//! @param os the stream to write to
+//! @param val the value to write
+//! @return `os`
+std::ostream &operator<<(std::ostream &os, const BigIntView &val);
+
+//! Write a BigInt to an output stream (see the BigIntView overload).
+//!
+//! @param os the stream to write to
+//! @param val the value to write
+//! @return `os`
+std::ostream &operator<<(std::ostream &os, const BigInt &val);
+
+//! Machine word on the left of a commutative operation or comparison
+//! (see the BigInt member overloads).
+template <typename T, EnableIfWord<T> = 0>
+BigInt operator+(T lhs, const BigInt &rhs) { return rhs + lhs; }
+template <typename T, EnableIfWord<T> = 0>
+BigInt operator*(T lhs, const BigInt &rhs) { return rhs * lhs; }
+template <typename T, EnableIfWord<T> = 0>
+BigInt operator-(T lhs, const BigInt &rhs) { return -(rhs - lhs); }
+template <typename T, EnableIfWord<T> = 0>
+bool operator==(T lhs, const BigInt &rhs) { return rhs.compare(lhs) == 0; }
+template <typename T, EnableIfWord<T> = 0>
+bool operator!=(T lhs, const BigInt &rhs) { return rhs.compare(lhs) != 0; }
+template <typename T, EnableIfWord<T> = 0>
+bool operator<(T lhs, const BigInt &rhs)  { return rhs.compare(lhs) > 0; }
+template <typename T, EnableIfWord<T> = 0>
+bool operator<=(T lhs, const BigInt &rhs) { return rhs.compare(lhs) >= 0; }
+template <typename T, EnableIfWord<T> = 0>
+bool operator>(T lhs, const BigInt &rhs)  { return rhs.compare(lhs) < 0; }
+template <typename T, EnableIfWord<T> = 0>
+bool operator>=(T lhs, const BigInt &rhs) { return rhs.compare(lhs) <= 0; }
+
+//! Divide by a single limb, returning both the quotient (rounded
+//! toward zero, as for `BigInt::operator/`) and the magnitude of the
+//! remainder. The remainder has the dividend's sign, i.e., `dividend`
+//! equals `quotient * divisor + remainder` for a non-negative dividend
+//! and `quotient * divisor - remainder` for a negative one.
+//!
+//! @param dividend the value to divide
+//! @param divisor the divisor
+//! @return the quotient and the remainder's magnitude
+//! @throw std::invalid_argument if `divisor` is 0
+std::pair<BigInt, uint64_t> divrem(const BigInt &dividend, uint64_t divisor);
+
+//! Multiply-accumulate: compute `acc += a * b` in `acc`'s own limbs.
+//! When the shorter operand is below the Karatsuba threshold, the
+//! product is added one row at a time (`mpn_addmul_1`), so neither the
+//! product nor a new sum is allocated and the limbs are walked once.
+//! Larger products go through a scratch product. The limb buffer of
+//! `acc` keeps its capacity, so hot loops stop reallocating once it
+//! has grown. Any operand may be (or share storage with) `acc`.
+//!
+//! @param acc the accumulator
+//! @param a left factor
+//! @param b right factor
+void addmul(BigInt &acc, const BigIntView &a, const BigIntView &b);
+
+//! Multiply-subtract: compute `acc -= a * b` in `acc`'s own limbs
+//! (see `addmul`).
+//!
+//! @param acc the accumulator
+//! @param a left factor
+//! @param b right factor
+void submul(BigInt &acc, const BigIntView &a, const BigIntView &b);
+
+//! Fused multiply-add: compute `a * b + c` with one pass over the
+//! result (see `addmul`) instead of a product followed by a sum.
+//!
+//! @param a left factor
+//! @param b right factor
+//! @param c the addend
+//! @return `a * b + c`
+BigInt fma(const BigIntView &a, const BigIntView &b, const BigInt &c);
+
+template <typename Rng>
+BigInt BigInt::random_bits(unsigned n, Rng &rng) {
+    std::vector<uint64_t> limbs((n + 63) / 64);
+    fill_random(limbs, n, rng);
+    return BigInt(std::move(limbs), false);
 }
 
+template <typename Rng>
+BigInt BigInt::random_below(const BigInt &bound, Rng &rng) {
+    if (bound.is_negative() || bound.is_zero()) {
+        throw std::invalid_argument("random_below bound must be positive");
+    }
 
-};
+    BigIntView bound_view(bound);
+    unsigned n = static_cast<unsigned>(64 * bound_view.size())
+               - static_cast<unsigned>(__builtin_clzll(bound_view.data()[bound_view.size() - 1]));
+
+    // Draw n-bit values until one is below the bound; since
+    // bound >= 2^(n-1), each draw succeeds with probability > 1/2
+    std::vector<uint64_t> limbs(bound_view.size());
+    do {
+        fill_random(limbs, n, rng);
+    } while (mpn_cmp(limbs.data(), bound_view.data(), limbs.size()) >= 0);
+
+    return BigInt(std::move(limbs), false);
+}
 
 #endif // BIGINT_H
\ No newline at end of file
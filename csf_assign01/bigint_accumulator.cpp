@@ -0,0 +1,57 @@
+#include "bigint_accumulator.h"
+#include "bigint_mpn.h"
+#include <algorithm>
+
+void BigIntAccumulator::accumulate(std::vector<uint64_t> &lo, std::vector<uint64_t> &hi,
+                                   const uint64_t *limbs, size_t n) {
+    if (lo.size() < n) {
+        lo.resize(n, 0);
+        hi.resize(n, 0);
+    }
+    // No limb depends on another, so this loop has no carry chain
+    uint64_t *l = lo.data(), *h = hi.data();
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t sum = l[i] + limbs[i];
+        h[i] += (sum < limbs[i]);
+        l[i] = sum;
+    }
+}
+
+BigInt BigIntAccumulator::resolve(const std::vector<uint64_t> &lo, const std::vector<uint64_t> &hi) {
+    size_t n = lo.size();
+    if (n == 0) {
+        return BigInt();
+    }
+    // lo + hi * 2^64, with room for the carry out of the top
+    std::vector<uint64_t> r(n + 2, 0);
+    std::copy(lo.begin(), lo.end(), r.begin());
+    r[n + 1] = mpn_add_n(r.data() + 1, r.data() + 1, hi.data(), n);
+    return BigIntView(r.data(), mpn_normalized_size(r.data(), n + 2)).to_bigint();
+}
+
+void BigIntAccumulator::add(const BigIntView &val) {
+    if (val.is_negative()) {
+        accumulate(neg_lo, neg_hi, val.data(), val.size());
+    } else {
+        accumulate(pos_lo, pos_hi, val.data(), val.size());
+    }
+}
+
+void BigIntAccumulator::sub(const BigIntView &val) {
+    add(-val);
+}
+
+BigInt BigIntAccumulator::value() const {
+    BigInt pos = resolve(pos_lo, pos_hi);
+    if (neg_lo.empty()) {
+        return pos;
+    }
+    return pos - resolve(neg_lo, neg_hi);
+}
+
+void BigIntAccumulator::clear() {
+    std::fill(pos_lo.begin(), pos_lo.end(), 0);
+    std::fill(pos_hi.begin(), pos_hi.end(), 0);
+    std::fill(neg_lo.begin(), neg_lo.end(), 0);
+    std::fill(neg_hi.begin(), neg_hi.end(), 0);
+}
@@ -0,0 +1,69 @@
+#ifndef BIGINT_ACCUMULATOR_H
+#define BIGINT_ACCUMULATOR_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "bigint.h"
+
+//! @file
+//! Carry-save accumulator for summing many BigInt values.
+
+//! Class summing a stream of BigInt values without a carry chain per
+//! addition. Each limb position keeps its own two-limb partial sum (a
+//! low limb and a count of the carries out of it), so adding a value
+//! touches only that value's limbs, each independently of the others,
+//! and never allocates once the accumulator is as wide as the widest
+//! value. Negative values go to a second set of partial sums. The
+//! carries are resolved only when `value()` is called.
+//!
+//! The carry count of a limb grows by at most one per addition, so
+//! up to 2^64 values can be added between calls to `clear()`.
+class BigIntAccumulator {
+private:
+   // Partial sums of the positive and negative values: the total of
+   // each is sum(lo[i] * 2^(64 i)) + sum(hi[i] * 2^(64 (i + 1)))
+   std::vector<uint64_t> pos_lo, pos_hi;
+   std::vector<uint64_t> neg_lo, neg_hi;
+
+   static void accumulate(std::vector<uint64_t> &lo, std::vector<uint64_t> &hi,
+                          const uint64_t *limbs, size_t n);
+   static BigInt resolve(const std::vector<uint64_t> &lo, const std::vector<uint64_t> &hi);
+
+public:
+  //! Constructor. The accumulator starts at 0.
+  BigIntAccumulator() {}
+
+  //! Add a value to the sum.
+  //!
+  //! @param val the value to add
+  void add(const BigIntView &val);
+
+  //! Subtract a value from the sum.
+  //!
+  //! @param val the value to subtract
+  void sub(const BigIntView &val);
+
+  //! Add a value to the sum (same as `add`).
+  //!
+  //! @param val the value to add
+  //! @return a reference to this accumulator
+  BigIntAccumulator &operator+=(const BigIntView &val) { add(val); return *this; }
+
+  //! Subtract a value from the sum (same as `sub`).
+  //!
+  //! @param val the value to subtract
+  //! @return a reference to this accumulator
+  BigIntAccumulator &operator-=(const BigIntView &val) { sub(val); return *this; }
+
+  //! Resolve the carries and return the sum. The accumulator is left
+  //! unchanged, so more values can be added afterwards.
+  //!
+  //! @return the sum of all values added (less those subtracted)
+  BigInt value() const;
+
+  //! Reset the sum to 0, keeping the allocated partial sums.
+  void clear();
+};
+
+#endif // BIGINT_ACCUMULATOR_H
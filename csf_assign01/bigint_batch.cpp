@@ -0,0 +1,247 @@
+#include "bigint_batch.h"
+#include <stdexcept>
+#include <algorithm>
+
+// Number of elements processed together by mul_mod; the per-tile
+// scratch rows ((limbs + 2) * TILE words) stay in L1/L2 cache
+static const size_t TILE = 64;
+
+BigIntBatch::BigIntBatch(size_t count, size_t limbs)
+    : count(count), width(limbs), data(count * limbs, 0) {}
+
+BigIntBatch BigIntBatch::pack(const std::vector<BigInt> &vals, size_t limbs) {
+    BigIntBatch batch(vals.size(), limbs);
+    for (size_t i = 0; i < vals.size(); ++i) {
+        batch.set(i, vals[i]);
+    }
+    return batch;
+}
+
+std::vector<BigInt> BigIntBatch::unpack() const {
+    std::vector<BigInt> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        result.push_back(get(i));
+    }
+    return result;
+}
+
+BigInt BigIntBatch::get(size_t i) const {
+    // Gather the element's limbs out of the rows, then build it in one go
+    std::vector<uint64_t> limbs(width);
+    for (size_t l = 0; l < width; ++l) {
+        limbs[l] = row(l)[i];
+    }
+    return BigIntView(limbs.data(), mpn_normalized_size(limbs.data(), width)).to_bigint();
+}
+
+void BigIntBatch::set(size_t i, const BigInt &val) {
+    if (val.is_negative()) {
+        throw std::invalid_argument("BigIntBatch elements must be non-negative");
+    }
+
+    if (BigIntView(val).size() > width) {
+        throw std::invalid_argument("Value does not fit in BigIntBatch element");
+    }
+
+    for (size_t l = 0; l < width; ++l) {
+        row(l)[i] = val.get_bits(l);
+    }
+}
+
+static void check_shapes(const BigIntBatch &out, const BigIntBatch &a, const BigIntBatch &b) {
+    if (a.size() != b.size() || a.limbs() != b.limbs()
+        || out.size() != a.size() || out.limbs() != a.limbs()) {
+        throw std::invalid_argument("BigIntBatch shapes do not match");
+    }
+}
+
+// The add/sub loops run limb-major with the element loop innermost and
+// branch-free carries, so the compiler turns each row into a vector
+// loop (this file is built with -O3; the 64-bit compares need SSE4.2
+// or AVX2, which SIMD_FLAGS in the Makefile can enable).
+
+void BigIntBatch::add(BigIntBatch &out, const BigIntBatch &a, const BigIntBatch &b,
+                      uint64_t *carry_out) {
+    check_shapes(out, a, b);
+
+    // (a local count, as the row stores could otherwise alias a.count)
+    size_t count = a.count;
+    std::vector<uint64_t> carry(count, 0);
+    for (size_t l = 0; l < a.width; ++l) {
+        const uint64_t *x = a.row(l);
+        const uint64_t *y = b.row(l);
+        uint64_t *z = out.row(l);
+        uint64_t *c = carry.data();
+        for (size_t e = 0; e < count; ++e) {
+            uint64_t s = x[e] + y[e];
+            uint64_t c1 = s < x[e];
+            uint64_t s2 = s + c[e];
+            uint64_t c2 = s2 < s;
+            z[e] = s2;
+            c[e] = c1 | c2;
+        }
+    }
+
+    if (carry_out) {
+        std::copy(carry.begin(), carry.end(), carry_out);
+    }
+}
+
+void BigIntBatch::sub(BigIntBatch &out, const BigIntBatch &a, const BigIntBatch &b,
+                      uint64_t *borrow_out) {
+    check_shapes(out, a, b);
+
+    // (a local count, as the row stores could otherwise alias a.count)
+    size_t count = a.count;
+    std::vector<uint64_t> borrow(count, 0);
+    for (size_t l = 0; l < a.width; ++l) {
+        const uint64_t *x = a.row(l);
+        const uint64_t *y = b.row(l);
+        uint64_t *z = out.row(l);
+        uint64_t *c = borrow.data();
+        for (size_t e = 0; e < count; ++e) {
+            uint64_t d = x[e] - y[e];
+            uint64_t b1 = x[e] < y[e];
+            uint64_t d2 = d - c[e];
+            uint64_t b2 = d < c[e];
+            z[e] = d2;
+            c[e] = b1 | b2;
+        }
+    }
+
+    if (borrow_out) {
+        std::copy(borrow.begin(), borrow.end(), borrow_out);
+    }
+}
+
+// Montgomery multiplication (CIOS) of a tile of elements:
+// t = x * y * 2^(-64n) mod N for elements [0, m) of the tile.
+// x and y are accessed through row pointers with stride `stride`;
+// `t` is (n + 2) rows of TILE scratch words and receives the result
+// in its first n rows. x86 vector units have no 64x64 -> 128-bit
+// multiply, so only the final subtraction vectorizes; the product
+// loops stay scalar, with independent lanes.
+static void mont_mul_tile(uint64_t *t, const uint64_t *x, const uint64_t *y, size_t stride,
+                          bool y_broadcast, size_t m, const std::vector<uint64_t> &mod,
+                          uint64_t ninv) {
+    size_t n = mod.size();
+    uint64_t carry[TILE], q[TILE];
+    std::fill(t, t + (n + 2) * TILE, 0);
+
+    for (size_t i = 0; i < n; ++i) {
+        // t += x * y[i]
+        std::fill(carry, carry + m, 0);
+        for (size_t j = 0; j < n; ++j) {
+            const uint64_t *xj = x + j * stride;
+            uint64_t *tj = t + j * TILE;
+            for (size_t e = 0; e < m; ++e) {
+                uint64_t yi = y_broadcast ? y[i] : y[i * stride + e];
+                unsigned __int128 p = (unsigned __int128) xj[e] * yi + tj[e] + carry[e];
+                tj[e] = (uint64_t) p;
+                carry[e] = (uint64_t) (p >> 64);
+            }
+        }
+        uint64_t *tn = t + n * TILE, *tn1 = t + (n + 1) * TILE;
+        for (size_t e = 0; e < m; ++e) {
+            unsigned __int128 s = (unsigned __int128) tn[e] + carry[e];
+            tn[e] = (uint64_t) s;
+            tn1[e] = (uint64_t) (s >> 64);
+        }
+
+        // t = (t + q * N) / 2^64, with q chosen so the low limb cancels
+        for (size_t e = 0; e < m; ++e) {
+            q[e] = t[e] * ninv;
+            unsigned __int128 p = (unsigned __int128) q[e] * mod[0] + t[e];
+            carry[e] = (uint64_t) (p >> 64);
+        }
+        for (size_t j = 1; j < n; ++j) {
+            uint64_t *tj = t + j * TILE, *tprev = t + (j - 1) * TILE;
+            for (size_t e = 0; e < m; ++e) {
+                unsigned __int128 p = (unsigned __int128) q[e] * mod[j] + tj[e] + carry[e];
+                tprev[e] = (uint64_t) p;
+                carry[e] = (uint64_t) (p >> 64);
+            }
+        }
+        uint64_t *tlast = t + (n - 1) * TILE;
+        for (size_t e = 0; e < m; ++e) {
+            unsigned __int128 s = (unsigned __int128) tn[e] + carry[e];
+            tlast[e] = (uint64_t) s;
+            tn[e] = tn1[e] + (uint64_t) (s >> 64);
+        }
+    }
+
+    // Conditional final subtraction: t < 2N, so subtract N exactly when
+    // t has a nonzero top limb or the low n limbs are >= N. First find
+    // the borrow of (low n limbs of t) - N, then do a masked subtract.
+    uint64_t borrow[TILE], mask[TILE];
+    std::fill(borrow, borrow + m, 0);
+    for (size_t j = 0; j < n; ++j) {
+        const uint64_t *tj = t + j * TILE;
+        for (size_t e = 0; e < m; ++e) {
+            uint64_t d = tj[e] - mod[j];
+            uint64_t b1 = tj[e] < mod[j];
+            uint64_t b2 = d < borrow[e];
+            borrow[e] = b1 | b2;
+        }
+    }
+
+    const uint64_t *tn = t + n * TILE;
+    for (size_t e = 0; e < m; ++e) {
+        uint64_t do_sub = (tn[e] != 0) | (borrow[e] == 0);
+        mask[e] = 0 - do_sub;
+        borrow[e] = 0;
+    }
+    for (size_t j = 0; j < n; ++j) {
+        uint64_t *tj = t + j * TILE;
+        for (size_t e = 0; e < m; ++e) {
+            uint64_t s = mod[j] & mask[e];
+            uint64_t d = tj[e] - s;
+            uint64_t b1 = tj[e] < s;
+            uint64_t d2 = d - borrow[e];
+            uint64_t b2 = d < borrow[e];
+            tj[e] = d2;
+            borrow[e] = b1 | b2;
+        }
+    }
+}
+
+void BigIntBatch::mul_mod(BigIntBatch &out, const BigIntBatch &a, const BigIntBatch &b,
+                          const BigInt &modulus) {
+    check_shapes(out, a, b);
+
+    size_t n = a.width;
+    if (modulus.is_negative() || modulus.is_zero() || (modulus.get_bits(0) & 1) == 0) {
+        throw std::invalid_argument("mul_mod modulus must be odd and positive");
+    }
+    if (BigIntView(modulus).size() > n) {
+        throw std::invalid_argument("mul_mod modulus is wider than the batch elements");
+    }
+    if (a.count == 0 || n == 0) {
+        return;
+    }
+
+    std::vector<uint64_t> mod(n);
+    for (size_t l = 0; l < n; ++l) {
+        mod[l] = modulus.get_bits(l);
+    }
+
+    // R = 2^(64n), with N zero-padded to n limbs
+    uint64_t ninv = mpn_neg_inverse_limb(mod[0]);
+    std::vector<uint64_t> r2(n);
+    mpn_pow2_mod(r2.data(), 128 * n, mod.data(), n);
+
+    std::vector<uint64_t> t((n + 2) * TILE), u((n + 2) * TILE);
+    for (size_t e0 = 0; e0 < a.count; e0 += TILE) {
+        size_t m = std::min(TILE, a.count - e0);
+
+        // u = a * b / R, then t = u * R^2 / R = a * b mod N
+        mont_mul_tile(u.data(), a.data.data() + e0, b.data.data() + e0, a.count,
+                      false, m, mod, ninv);
+        mont_mul_tile(t.data(), u.data(), r2.data(), TILE, true, m, mod, ninv);
+
+        for (size_t l = 0; l < n; ++l) {
+            std::copy(t.data() + l * TILE, t.data() + l * TILE + m, out.row(l) + e0);
+        }
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef BIGINT_BATCH_H
+#define BIGINT_BATCH_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "bigint.h"
+
+//! @file
+//! Batch of same-width non-negative BigInt values in structure-of-arrays layout.
+
+//! Class representing a batch of `count` non-negative integers, each
+//! `limbs` 64-bit limbs wide. Limb `l` of every element is stored
+//! contiguously (the "row" for limb `l`), so the batch kernels can
+//! process many elements per instruction instead of walking one
+//! BigInt at a time. Arithmetic is fixed-width: `add` and `sub` wrap
+//! modulo 2^(64*limbs) and report the carry/borrow out of each element.
+class BigIntBatch {
+private:
+   size_t count;
+   size_t width;
+   std::vector<uint64_t> data;
+
+public:
+  //! Constructor. All elements are initialized to 0.
+  //!
+  //! @param count number of elements in the batch
+  //! @param limbs number of 64-bit limbs per element
+  BigIntBatch(size_t count, size_t limbs);
+
+  //! Pack a sequence of BigInt values into a batch.
+  //!
+  //! @param vals the values to pack (element `i` of the batch is `vals[i]`)
+  //! @param limbs number of 64-bit limbs per element
+  //! @return the packed batch
+  //! @throw std::invalid_argument if any value is negative or does not
+  //!        fit in `limbs` limbs
+  static BigIntBatch pack(const std::vector<BigInt> &vals, size_t limbs);
+
+  //! Unpack every element of the batch into a BigInt.
+  //!
+  //! @return vector of BigInt values (element `i` is batch element `i`)
+  std::vector<BigInt> unpack() const;
+
+  //! Get one element of the batch as a BigInt.
+  //!
+  //! @param i index of the element
+  //! @return the value of element `i`
+  BigInt get(size_t i) const;
+
+  //! Set one element of the batch from a BigInt.
+  //!
+  //! @param i index of the element
+  //! @param val the new value
+  //! @throw std::invalid_argument if `val` is negative or does not fit
+  void set(size_t i, const BigInt &val);
+
+  //! @return the number of elements in the batch
+  size_t size() const { return count; }
+
+  //! @return the number of 64-bit limbs per element
+  size_t limbs() const { return width; }
+
+  //! Get the contiguous row holding limb `l` of every element.
+  //!
+  //! @param l the limb index (0 is the least significant limb)
+  //! @return pointer to `size()` values, one per element
+  uint64_t *row(size_t l) { return data.data() + l * count; }
+  const uint64_t *row(size_t l) const { return data.data() + l * count; }
+
+  //! Element-wise addition modulo 2^(64*limbs): `out[i] = a[i] + b[i]`.
+  //! `out` may be the same object as `a` or `b`.
+  //!
+  //! @param out batch receiving the sums
+  //! @param a left operands
+  //! @param b right operands
+  //! @param carry_out if non-null, receives `size()` carry-out values (0 or 1)
+  //! @throw std::invalid_argument if the batch shapes differ
+  static void add(BigIntBatch &out, const BigIntBatch &a, const BigIntBatch &b,
+                  uint64_t *carry_out = nullptr);
+
+  //! Element-wise subtraction modulo 2^(64*limbs): `out[i] = a[i] - b[i]`.
+  //! `out` may be the same object as `a` or `b`.
+  //!
+  //! @param out batch receiving the differences
+  //! @param a left operands
+  //! @param b right operands
+  //! @param borrow_out if non-null, receives `size()` borrow-out values (0 or 1)
+  //! @throw std::invalid_argument if the batch shapes differ
+  static void sub(BigIntBatch &out, const BigIntBatch &a, const BigIntBatch &b,
+                  uint64_t *borrow_out = nullptr);
+
+  //! Element-wise modular multiplication: `out[i] = a[i] * b[i] mod modulus`,
+  //! using Montgomery multiplication. Every element of `a` and `b` must
+  //! already be less than `modulus`. `out` may be the same object as
+  //! `a` or `b`.
+  //!
+  //! @param out batch receiving the products
+  //! @param a left operands
+  //! @param b right operands
+  //! @param modulus the (odd, positive) modulus shared by all elements
+  //! @throw std::invalid_argument if the batch shapes differ, or the
+  //!        modulus is even, non-positive, or wider than the batch
+  static void mul_mod(BigIntBatch &out, const BigIntBatch &a, const BigIntBatch &b,
+                      const BigInt &modulus);
+};
+
+#endif // BIGINT_BATCH_H
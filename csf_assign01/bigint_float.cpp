@@ -0,0 +1,354 @@
+#include "bigint_float.h"
+#include "bigint_math.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <stdexcept>
+
+static void check_precision(unsigned prec) {
+    if (prec == 0) {
+        throw std::invalid_argument("BigFloat precision must be at least 1 bit");
+    }
+}
+
+// v * 2^n for a non-negative n, keeping the sign of v. BigInt shifts
+// take an unsigned count, so larger exponent gaps are refused rather
+// than truncated.
+static BigInt shift_left(const BigInt &v, int64_t n) {
+    if (n < 0 || static_cast<uint64_t>(n) > UINT_MAX) {
+        throw std::invalid_argument("BigFloat exponent range is too large to align");
+    }
+    unsigned count = static_cast<unsigned>(n);
+    return v.is_negative() ? -((-v) << count) : v << count;
+}
+
+static BigInt magnitude(const BigInt &v) {
+    return v.is_negative() ? -v : v;
+}
+
+BigFloat::BigFloat()
+    : exp(0), prec(DEFAULT_PRECISION), mode(RoundingMode::NEAREST_EVEN) {}
+
+BigFloat::BigFloat(const BigInt &val, unsigned prec, RoundingMode mode)
+    : mant(val), exp(0), prec(prec), mode(mode) {
+    check_precision(prec);
+    round(false);
+}
+
+BigFloat::BigFloat(double d, unsigned prec, RoundingMode mode)
+    : exp(0), prec(prec), mode(mode) {
+    check_precision(prec);
+    if (!std::isfinite(d)) {
+        throw std::invalid_argument("Cannot convert an infinite or NaN value to BigFloat");
+    }
+    // d = frac * 2^e, with the 53-bit mantissa frac * 2^53 an integer
+    int e;
+    double frac = std::frexp(std::fabs(d), &e);
+    mant = BigInt(static_cast<uint64_t>(std::ldexp(frac, 53)), d < 0);
+    exp = e - 53;
+    round(false);
+}
+
+BigFloat BigFloat::from_parts(const BigInt &mantissa, int64_t exponent,
+                              unsigned prec, RoundingMode mode) {
+    check_precision(prec);
+    BigFloat result;
+    result.mant = mantissa;
+    result.exp = exponent;
+    result.prec = prec;
+    result.mode = mode;
+    result.round(false);
+    return result;
+}
+
+void BigFloat::round(bool sticky) {
+    if (mant.is_zero()) {
+        exp = 0;
+        return;
+    }
+    bool neg = mant.is_negative();
+    BigInt mag = magnitude(mant);
+    size_t bits = mag.bit_length();
+
+    // An inexact value needs a round bit below the kept bits, so the
+    // sticky part lies below that
+    if (sticky && bits <= prec + 1) {
+        size_t pad = prec + 2 - bits;
+        mag = mag << pad;
+        exp -= static_cast<int64_t>(pad);
+        bits += pad;
+    }
+
+    if (bits > prec) {
+        size_t shift = bits - prec;
+        bool round_bit = mag.is_bit_set(shift - 1);
+        bool rest = sticky || mag.countr_zero() < shift - 1;
+        mag = mag >> shift;
+        exp += static_cast<int64_t>(shift);
+
+        bool up = false;
+        switch (mode) {
+        case RoundingMode::NEAREST_EVEN:
+            up = round_bit && (rest || mag.is_bit_set(0));
+            break;
+        case RoundingMode::TOWARD_ZERO:
+            break;
+        case RoundingMode::TOWARD_POSITIVE:
+            up = (round_bit || rest) && !neg;
+            break;
+        case RoundingMode::TOWARD_NEGATIVE:
+            up = (round_bit || rest) && neg;
+            break;
+        }
+        if (up) {
+            mag = mag + 1;  // a carry out of the top leaves a power of two
+        }
+    }
+
+    size_t zeros = mag.countr_zero();
+    if (zeros) {
+        mag = mag >> zeros;
+        exp += static_cast<int64_t>(zeros);
+    }
+    mant = neg ? -mag : mag;
+}
+
+void BigFloat::set_precision(unsigned prec) {
+    check_precision(prec);
+    this->prec = prec;
+    round(false);
+}
+
+BigFloat BigFloat::add(const BigFloat &a, const BigFloat &b, unsigned prec, RoundingMode mode) {
+    if (a.is_zero() || b.is_zero()) {
+        const BigFloat &other = a.is_zero() ? b : a;
+        return from_parts(other.mant, other.exp, prec, mode);
+    }
+
+    // Order by the position just above the top bit
+    int64_t top_a = a.exp + static_cast<int64_t>(a.mant.bit_length());
+    int64_t top_b = b.exp + static_cast<int64_t>(b.mant.bit_length());
+    const BigFloat &hi = (top_a >= top_b) ? a : b;
+    const BigFloat &lo = (top_a >= top_b) ? b : a;
+    int64_t top_hi = std::max(top_a, top_b), top_lo = std::min(top_a, top_b);
+
+    // If lo is entirely below both hi's lowest bit and the result's
+    // round bit, it only decides which way hi is rounded, and so does
+    // any value between 0 and 2^(s+1) of the same sign: use 2^s. That
+    // keeps the alignment shift bounded whatever the exponent gap.
+    BigInt lo_mant = lo.mant;
+    int64_t lo_exp = lo.exp;
+    int64_t s = std::min(hi.exp, top_hi - static_cast<int64_t>(prec) - 3) - 1;
+    if (top_lo <= s + 1) {
+        lo_mant = BigInt(1, lo.is_negative());
+        lo_exp = s;
+    }
+
+    int64_t e = std::min(hi.exp, lo_exp);
+    BigInt sum = shift_left(hi.mant, hi.exp - e) + shift_left(lo_mant, lo_exp - e);
+    return from_parts(sum, e, prec, mode);
+}
+
+BigFloat BigFloat::sub(const BigFloat &a, const BigFloat &b, unsigned prec, RoundingMode mode) {
+    return add(a, -b, prec, mode);
+}
+
+BigFloat BigFloat::mul(const BigFloat &a, const BigFloat &b, unsigned prec, RoundingMode mode) {
+    return from_parts(a.mant * b.mant, a.exp + b.exp, prec, mode);
+}
+
+BigFloat BigFloat::div(const BigFloat &a, const BigFloat &b, unsigned prec, RoundingMode mode) {
+    check_precision(prec);
+    if (b.is_zero()) {
+        throw std::invalid_argument("Division by zero");
+    }
+    if (a.is_zero()) {
+        return from_parts(BigInt(), 0, prec, mode);
+    }
+
+    // Scale the dividend so the quotient has at least prec + 2 bits;
+    // a nonzero remainder makes the result sticky
+    BigInt num = magnitude(a.mant), den = magnitude(b.mant);
+    int64_t k = std::max<int64_t>(0, static_cast<int64_t>(prec + 2 + den.bit_length())
+                                         - static_cast<int64_t>(num.bit_length()));
+    num = shift_left(num, k);
+    BigInt q = num / den;
+    bool sticky = !(num - q * den).is_zero();
+
+    BigFloat result;
+    result.mant = (a.is_negative() != b.is_negative()) ? -q : q;
+    result.exp = a.exp - b.exp - k;
+    result.prec = prec;
+    result.mode = mode;
+    result.round(sticky);
+    return result;
+}
+
+BigFloat BigFloat::sqrt(const BigFloat &a, unsigned prec, RoundingMode mode) {
+    check_precision(prec);
+    if (a.is_negative()) {
+        throw std::invalid_argument("Square root of negative BigFloat");
+    }
+    if (a.is_zero()) {
+        return from_parts(BigInt(), 0, prec, mode);
+    }
+
+    // sqrt(m * 2^e) = sqrt(m * 2^s) * 2^((e - s) / 2): pick s to make
+    // e - s even and the integer root at least prec + 2 bits long
+    int64_t s = std::max<int64_t>(0, 2 * static_cast<int64_t>(prec) + 4
+                                         - static_cast<int64_t>(a.mant.bit_length()));
+    if ((a.exp - s) % 2 != 0) {
+        ++s;
+    }
+    BigInt scaled = shift_left(a.mant, s);
+    BigInt root = isqrt(scaled);
+
+    BigFloat result;
+    result.mant = root;
+    result.exp = (a.exp - s) / 2;
+    result.prec = prec;
+    result.mode = mode;
+    result.round(root * root != scaled);
+    return result;
+}
+
+BigFloat BigFloat::operator+(const BigFloat &rhs) const {
+    return add(*this, rhs, std::max(prec, rhs.prec), mode);
+}
+
+BigFloat BigFloat::operator-(const BigFloat &rhs) const {
+    return sub(*this, rhs, std::max(prec, rhs.prec), mode);
+}
+
+BigFloat BigFloat::operator*(const BigFloat &rhs) const {
+    return mul(*this, rhs, std::max(prec, rhs.prec), mode);
+}
+
+BigFloat BigFloat::operator/(const BigFloat &rhs) const {
+    return div(*this, rhs, std::max(prec, rhs.prec), mode);
+}
+
+BigFloat BigFloat::operator-() const {
+    BigFloat result = *this;
+    result.mant = -mant;
+    return result;
+}
+
+int BigFloat::compare(const BigFloat &rhs) const {
+    int sign = is_zero() ? 0 : (is_negative() ? -1 : 1);
+    int rhs_sign = rhs.is_zero() ? 0 : (rhs.is_negative() ? -1 : 1);
+    if (sign != rhs_sign) {
+        return sign < rhs_sign ? -1 : 1;
+    }
+    if (sign == 0) {
+        return 0;
+    }
+
+    // Same sign: compare the magnitudes by their top bits first, and
+    // only align the mantissas when those match
+    int64_t top = exp + static_cast<int64_t>(mant.bit_length());
+    int64_t rhs_top = rhs.exp + static_cast<int64_t>(rhs.mant.bit_length());
+    int cmp;
+    if (top != rhs_top) {
+        cmp = top > rhs_top ? 1 : -1;
+    } else {
+        int64_t e = std::min(exp, rhs.exp);
+        cmp = shift_left(magnitude(mant), exp - e).compare(shift_left(magnitude(rhs.mant), rhs.exp - e));
+    }
+    return sign * cmp;
+}
+
+double BigFloat::to_double() const {
+    if (is_zero()) {
+        return 0.0;
+    }
+    // Round to the bits a double keeps at this magnitude (53, fewer for
+    // subnormals, whose lowest bit is 2^-1074), then scale (exactly,
+    // unless the result is out of range)
+    int64_t top = exp + static_cast<int64_t>(mant.bit_length());
+    int64_t bits = std::min<int64_t>(53, top + 1074);
+    if (bits <= 0) {
+        // Below 2^-1074: the nearest double is 2^-1074 above half of it
+        // (a tie goes to the even zero), otherwise zero
+        BigInt abs_mant = magnitude(mant);
+        bool above_half = bits == 0 && abs_mant != (BigInt(1) << (abs_mant.bit_length() - 1));
+        double d = above_half ? std::ldexp(1.0, -1074) : 0.0;
+        return is_negative() ? -d : d;
+    }
+    BigFloat rounded = from_parts(mant, exp, static_cast<unsigned>(bits), RoundingMode::NEAREST_EVEN);
+    int64_t e = std::max<int64_t>(std::min<int64_t>(rounded.exp, 1 << 20), -(1 << 20));
+    return std::ldexp(rounded.mant.to_double(), static_cast<int>(e));
+}
+
+// 10^k (k >= 0) by repeated squaring
+static BigInt pow10(int64_t k) {
+    BigInt result(1), base(10);
+    for (uint64_t e = static_cast<uint64_t>(k); e; e >>= 1) {
+        if (e & 1) {
+            result = result * base;
+        }
+        if (e > 1) {
+            base = base * base;
+        }
+    }
+    return result;
+}
+
+std::string BigFloat::to_string(size_t digits) const {
+    if (is_zero()) {
+        return "0";
+    }
+    // log10(2) = 0.30103; one more digit than the precision spans
+    // tells apart neighbouring values
+    size_t n = digits ? digits : static_cast<size_t>(std::ceil(prec * 0.30102999566398120)) + 1;
+
+    // Estimate the decimal exponent, then find D, the n-digit integer
+    // nearest to |value| * 10^(n - 1 - dec_exp), fixing the estimate
+    // if D comes out with the wrong number of digits
+    double log10_mag = (mant.log2_approx() + static_cast<double>(exp)) * 0.30102999566398120;
+    int64_t dec_exp = static_cast<int64_t>(std::floor(log10_mag));
+    BigInt low = pow10(static_cast<int64_t>(n) - 1), high = low * 10;
+    BigInt d;
+    for (;;) {
+        BigInt num = magnitude(mant), den(1);
+        if (exp >= 0) {
+            num = shift_left(num, exp);
+        } else {
+            den = shift_left(den, -exp);
+        }
+        int64_t scale = static_cast<int64_t>(n) - 1 - dec_exp;
+        if (scale >= 0) {
+            num = num * pow10(scale);
+        } else {
+            den = den * pow10(-scale);
+        }
+
+        // Round half to even
+        d = num / den;
+        BigInt twice_rem = (num - d * den) << 1;
+        int cmp = twice_rem.compare(den);
+        if (cmp > 0 || (cmp == 0 && d.is_bit_set(0))) {
+            d = d + 1;
+        }
+
+        if (d >= high) {
+            ++dec_exp;
+        } else if (d < low) {
+            --dec_exp;
+        } else {
+            break;
+        }
+    }
+
+    std::string str = d.to_dec();
+    std::string result = is_negative() ? "-" : "";
+    result += str[0];
+    if (str.size() > 1) {
+        result += '.';
+        result.append(str, 1, std::string::npos);
+    }
+    std::string exp_digits = std::to_string(dec_exp < 0 ? -dec_exp : dec_exp);
+    result += (dec_exp < 0) ? "e-" : "e+";
+    result += (exp_digits.size() < 2) ? "0" + exp_digits : exp_digits;
+    return result;
+}
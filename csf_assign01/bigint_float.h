@@ -0,0 +1,175 @@
+#ifndef BIGINT_FLOAT_H
+#define BIGINT_FLOAT_H
+
+#include <string>
+#include <cstdint>
+#include "bigint.h"
+
+//! @file
+//! Arbitrary-precision binary floating point on BigInt mantissas.
+
+//! How results that are not exactly representable are rounded.
+enum class RoundingMode {
+  NEAREST_EVEN,     //!< to the nearest value, ties to an even mantissa
+  TOWARD_ZERO,      //!< truncate the magnitude
+  TOWARD_POSITIVE,  //!< toward +infinity (ceiling)
+  TOWARD_NEGATIVE,  //!< toward -infinity (floor)
+};
+
+//! Class representing a binary floating-point value
+//! mantissa * 2^exponent, with a BigInt mantissa of at most
+//! `precision()` bits and an `int64_t` exponent. Trailing zero bits
+//! are moved into the exponent, so values never carry unused bits.
+//!
+//! Every result is the exact result rounded once to its precision, in
+//! its rounding mode. The operators give their result the larger
+//! precision of the two operands and the left operand's rounding mode;
+//! the static functions take both explicitly. Multiplication uses
+//! BigInt's multiplication (so Karatsuba at high precision), and
+//! division uses BigInt's division.
+class BigFloat {
+private:
+   BigInt mant;        // 0, or odd
+   int64_t exp;
+   unsigned prec;
+   RoundingMode mode;
+
+   // Round mant * 2^exp to prec bits in mode and strip trailing zeros.
+   // `sticky` means the exact value is a little larger in magnitude
+   // (by less than one unit in the last bit of mant).
+   void round(bool sticky);
+
+public:
+  //! Precision (in bits) of values constructed without one.
+  static const unsigned DEFAULT_PRECISION = 256;
+
+  //! Default constructor: zero, with the default precision,
+  //! rounding to nearest.
+  BigFloat();
+
+  //! Constructor from an integer, rounded to `prec` bits.
+  //!
+  //! @param val the value
+  //! @param prec the precision in bits (at least 1)
+  //! @param mode the rounding mode
+  //! @throw std::invalid_argument if `prec` is 0
+  explicit BigFloat(const BigInt &val, unsigned prec = DEFAULT_PRECISION,
+                    RoundingMode mode = RoundingMode::NEAREST_EVEN);
+
+  //! Constructor from a `double`, rounded to `prec` bits.
+  //!
+  //! @param d the value
+  //! @param prec the precision in bits (at least 1)
+  //! @param mode the rounding mode
+  //! @throw std::invalid_argument if `prec` is 0, or `d` is infinite or NaN
+  explicit BigFloat(double d, unsigned prec = DEFAULT_PRECISION,
+                    RoundingMode mode = RoundingMode::NEAREST_EVEN);
+
+  //! Build mantissa * 2^exponent, rounded to `prec` bits.
+  //!
+  //! @param mantissa the mantissa
+  //! @param exponent the power of two it is scaled by
+  //! @param prec the precision in bits (at least 1)
+  //! @param mode the rounding mode
+  //! @return the value
+  //! @throw std::invalid_argument if `prec` is 0
+  static BigFloat from_parts(const BigInt &mantissa, int64_t exponent,
+                             unsigned prec = DEFAULT_PRECISION,
+                             RoundingMode mode = RoundingMode::NEAREST_EVEN);
+
+  //! @return the mantissa (0, or odd)
+  const BigInt &mantissa() const { return mant; }
+
+  //! @return the exponent: the value is `mantissa() * 2^exponent()`
+  int64_t exponent() const { return exp; }
+
+  //! @return the precision in bits
+  unsigned precision() const { return prec; }
+
+  //! @return the rounding mode
+  RoundingMode rounding_mode() const { return mode; }
+
+  //! Change the precision, rounding the value (in this value's
+  //! rounding mode) if it no longer fits.
+  //!
+  //! @param prec the new precision in bits (at least 1)
+  //! @throw std::invalid_argument if `prec` is 0
+  void set_precision(unsigned prec);
+
+  //! Change the rounding mode used for results computed from this value.
+  //!
+  //! @param mode the new rounding mode
+  void set_rounding_mode(RoundingMode mode) { this->mode = mode; }
+
+  //! @return true if the value is zero
+  bool is_zero() const { return mant.is_zero(); }
+
+  //! @return true if the value is negative
+  bool is_negative() const { return mant.is_negative(); }
+
+  //! Correctly rounded sum, difference, product and quotient.
+  //!
+  //! @param a left operand
+  //! @param b right operand
+  //! @param prec precision of the result (at least 1)
+  //! @param mode rounding mode of the result
+  //! @return the rounded result
+  //! @throw std::invalid_argument if `prec` is 0 (or, for `div`, if
+  //!        `b` is zero)
+  static BigFloat add(const BigFloat &a, const BigFloat &b, unsigned prec, RoundingMode mode);
+  static BigFloat sub(const BigFloat &a, const BigFloat &b, unsigned prec, RoundingMode mode);
+  static BigFloat mul(const BigFloat &a, const BigFloat &b, unsigned prec, RoundingMode mode);
+  static BigFloat div(const BigFloat &a, const BigFloat &b, unsigned prec, RoundingMode mode);
+
+  //! Correctly rounded square root.
+  //!
+  //! @param a the argument (must not be negative)
+  //! @param prec precision of the result (at least 1)
+  //! @param mode rounding mode of the result
+  //! @return the rounded square root
+  //! @throw std::invalid_argument if `a` is negative or `prec` is 0
+  static BigFloat sqrt(const BigFloat &a, unsigned prec, RoundingMode mode);
+
+  //! @return the square root, in this value's precision and rounding mode
+  //! @throw std::invalid_argument if the value is negative
+  BigFloat sqrt() const { return sqrt(*this, prec, mode); }
+
+  BigFloat operator+(const BigFloat &rhs) const;
+  BigFloat operator-(const BigFloat &rhs) const;
+  BigFloat operator*(const BigFloat &rhs) const;
+
+  //! @throw std::invalid_argument if `rhs` is zero
+  BigFloat operator/(const BigFloat &rhs) const;
+
+  //! @return the negated value (exact)
+  BigFloat operator-() const;
+
+  //! Compare the exact values.
+  //!
+  //! @param rhs the right-hand side value
+  //! @return negative, 0 or positive as this value is less than,
+  //!         equal to or greater than `rhs`
+  int compare(const BigFloat &rhs) const;
+
+  bool operator==(const BigFloat &rhs) const { return compare(rhs) == 0; }
+  bool operator!=(const BigFloat &rhs) const { return compare(rhs) != 0; }
+  bool operator<(const BigFloat &rhs) const  { return compare(rhs) < 0; }
+  bool operator<=(const BigFloat &rhs) const { return compare(rhs) <= 0; }
+  bool operator>(const BigFloat &rhs) const  { return compare(rhs) > 0; }
+  bool operator>=(const BigFloat &rhs) const { return compare(rhs) >= 0; }
+
+  //! @return the nearest `double` (infinity if out of range)
+  double to_double() const;
+
+  //! Format in decimal scientific notation, as `printf`'s `%e` does
+  //! (e.g. `-1.2345e+67`), with the digits rounded to nearest.
+  //!
+  //! @param digits number of significant digits; 0 (the default)
+  //!        means enough to tell apart all values of this precision
+  //! @return the formatted value
+  //! @throw std::invalid_argument if the binary exponent is beyond
+  //!        +/- 2^32 (the value can't be scaled to an integer)
+  std::string to_string(size_t digits = 0) const;
+};
+
+#endif // BIGINT_FLOAT_H
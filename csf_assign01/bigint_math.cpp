@@ -0,0 +1,534 @@
+#include "bigint_math.h"
+#include "bigint_montgomery.h"
+#include "bigint_mpn.h"
+#include <algorithm>
+#include <future>
+#include <random>
+#include <stdexcept>
+
+// Subtrees with at least this many leaves may be multiplied on another thread
+static const size_t PARALLEL_PRODUCT_LEAVES = 64;
+
+// Product of vals[lo, hi) by recursive halving. Large subtrees hand
+// their left half to a worker thread when the thread budget (shared
+// with parallel multiplication) has one to spare.
+static BigInt product_tree(const BigInt *vals, size_t lo, size_t hi) {
+    if (hi - lo == 1) {
+        return vals[lo];
+    }
+    if (hi - lo == 2) {
+        return vals[lo] * vals[lo + 1];
+    }
+
+    size_t mid = lo + (hi - lo) / 2;
+    if (hi - lo >= PARALLEL_PRODUCT_LEAVES) {
+        BigInt::ThreadSlot slot;
+        if (slot.acquire()) {
+            std::future<BigInt> task = std::async(std::launch::async, product_tree, vals, lo, mid);
+            BigInt right = product_tree(vals, mid, hi);
+            BigInt left = task.get();
+            // The worker is done: let the final multiplication use it
+            slot.release();
+            return left * right;
+        }
+    }
+    return product_tree(vals, lo, mid) * product_tree(vals, mid, hi);
+}
+
+BigInt product(const BigInt *vals, size_t n) {
+    if (n == 0) {
+        return BigInt(1);
+    }
+    return product_tree(vals, 0, n);
+}
+
+BigInt product(const std::vector<BigInt> &vals) {
+    return product(vals.data(), vals.size());
+}
+
+// Collects small factors, packing as many as fit into each 64-bit
+// word, so the product tree's leaves are full limbs
+class FactorPacker {
+private:
+   std::vector<BigInt> words;
+   uint64_t current;
+
+public:
+   FactorPacker() : current(1) {}
+
+   void add(uint64_t f) {
+       if (current > UINT64_MAX / f) {
+           words.push_back(BigInt(current));
+           current = 1;
+       }
+       current *= f;
+   }
+
+   BigInt product() {
+       if (current > 1) {
+           words.push_back(BigInt(current));
+           current = 1;
+       }
+       return ::product(words);
+   }
+};
+
+BigInt factorial(uint64_t n) {
+    // n! = 2^(n - popcount(n)) * (product of the odd parts of 2..n)
+    FactorPacker odd_parts;
+    for (uint64_t i = 3; i <= n; ++i) {
+        uint64_t odd = i >> __builtin_ctzll(i);
+        if (odd > 1) {
+            odd_parts.add(odd);
+        }
+    }
+    unsigned twos = static_cast<unsigned>(n - __builtin_popcountll(n));
+    return odd_parts.product() << twos;
+}
+
+BigInt binomial(uint64_t n, uint64_t k) {
+    if (k > n) {
+        return BigInt();
+    }
+    if (k > n - k) {
+        k = n - k;
+    }
+    if (k == 0) {
+        return BigInt(1);
+    }
+
+    // The sieve below costs O(n) time and space however small k is, so
+    // for k well below n (or n too large to sieve) divide the product
+    // of the k top factors by k! instead
+    if (k < n / 16 || n == UINT64_MAX) {
+        FactorPacker top;
+        for (uint64_t i = n - k + 1; i <= n && i != 0; ++i) {
+            top.add(i);
+        }
+        return top.product() / factorial(k);
+    }
+
+    // Sieve of Eratosthenes up to n
+    std::vector<bool> composite(n + 1, false);
+    FactorPacker factors;
+    for (uint64_t p = 2; p <= n; ++p) {
+        if (composite[p]) {
+            continue;
+        }
+        for (uint64_t m = p * p; p <= n / p && m <= n; m += p) {
+            composite[m] = true;
+        }
+
+        // Legendre's formula: e = sum over i of n/p^i - k/p^i - (n-k)/p^i
+        uint64_t e = 0;
+        for (uint64_t q = n, a = k, b = n - k; q > 0; q /= p, a /= p, b /= p) {
+            e += (q / p) - (a / p) - (b / p);
+        }
+        for (uint64_t i = 0; i < e; ++i) {
+            factors.add(p);
+        }
+    }
+    return factors.product();
+}
+
+// Remainder of |n| divided by a single limb
+static uint64_t mod_small(const BigIntView &n, uint64_t m) {
+    return mpn_mod_1(n.data(), n.size(), m);
+}
+
+BigInt isqrt(const BigInt &n) {
+    if (n.is_negative() && !n.is_zero()) {
+        throw std::invalid_argument("Square root of negative BigInt");
+    }
+    if (n.is_zero()) {
+        return BigInt();
+    }
+
+    // Digit-by-digit (base 2) square root: bit runs over the powers of 4
+    BigInt x = n;
+    BigInt result;
+    BigInt bit = BigInt(1) << ((n.bit_length() - 1) & ~size_t(1));
+    while (!bit.is_zero()) {
+        BigInt trial = result + bit;
+        if (x >= trial) {
+            x = x - trial;
+            result = (result >> 1) + bit;
+        } else {
+            result = result >> 1;
+        }
+        bit = bit >> 2;
+    }
+    return result;
+}
+
+// Shift out the trailing zero bits of a nonzero n-limb value, in place,
+// and return its new size
+static size_t strip_twos(uint64_t *v, size_t n) {
+    size_t zero_limbs = 0;
+    while (v[zero_limbs] == 0) {
+        ++zero_limbs;
+    }
+    if (zero_limbs) {
+        std::copy(v + zero_limbs, v + n, v);
+        n -= zero_limbs;
+    }
+    unsigned bits = __builtin_ctzll(v[0]);
+    if (bits) {
+        mpn_rshift(v, v, n, bits);
+    }
+    return mpn_normalized_size(v, n);
+}
+
+BigInt gcd(const BigInt &a, const BigInt &b) {
+    BigIntView x(a), y(b);
+    if (x.is_zero() || y.is_zero()) {
+        const BigInt &other = x.is_zero() ? b : a;
+        return other.is_negative() ? -other : other;
+    }
+
+    // gcd = 2^k * gcd(odd part of a, odd part of b)
+    size_t k = std::min(a.countr_zero(), b.countr_zero());
+    std::vector<uint64_t> u(x.data(), x.data() + x.size()), v(y.data(), y.data() + y.size());
+    size_t un = strip_twos(u.data(), u.size()), vn = strip_twos(v.data(), v.size());
+
+    // u and v are odd here, and stay so at the top of the loop
+    std::vector<uint64_t> q, r;
+    for (;;) {
+        int cmp = (un != vn) ? (un > vn ? 1 : -1) : mpn_cmp(u.data(), v.data(), un);
+        if (cmp == 0) {
+            break;
+        }
+        if (cmp < 0) {
+            std::swap(u, v);
+            std::swap(un, vn);
+        }
+
+        if (un > vn + 1) {
+            // gcd(u, v) = gcd(u mod v, v): one division instead of many subtractions
+            q.resize(un - vn + 1);
+            r.resize(vn);
+            mpn_tdiv_qr(q.data(), r.data(), u.data(), un, v.data(), vn);
+            size_t rn = mpn_normalized_size(r.data(), vn);
+            if (rn == 0) {
+                break;  // v divides u
+            }
+            std::copy(r.begin(), r.begin() + rn, u.begin());
+            un = strip_twos(u.data(), rn);
+            continue;
+        }
+
+        // u - v is even and nonzero
+        mpn_sub(u.data(), u.data(), un, v.data(), vn);
+        un = strip_twos(u.data(), mpn_normalized_size(u.data(), un));
+    }
+
+    return BigIntView(v.data(), vn).to_bigint() << k;
+}
+
+// Odd primes below 2048, and groups of them whose products fit in a
+// single limb, so trial division costs one multi-limb remainder per group
+struct SmallPrimes {
+    std::vector<uint64_t> primes;
+    std::vector<uint64_t> group_products;
+    std::vector<LimbDivisor> group_divisors;  // reciprocals of group_products
+    std::vector<size_t> group_ends;  // primes[group_ends[g-1] .. group_ends[g]) are group g
+
+    SmallPrimes() {
+        const uint64_t limit = 2048;
+        std::vector<bool> composite(limit, false);
+        for (uint64_t p = 3; p < limit; p += 2) {
+            if (composite[p]) {
+                continue;
+            }
+            primes.push_back(p);
+            for (uint64_t m = p * p; m < limit; m += 2 * p) {
+                composite[m] = true;
+            }
+        }
+
+        uint64_t prod = 1;
+        for (size_t i = 0; i < primes.size(); ++i) {
+            if (prod > UINT64_MAX / primes[i]) {
+                group_products.push_back(prod);
+                group_ends.push_back(i);
+                prod = 1;
+            }
+            prod *= primes[i];
+        }
+        group_products.push_back(prod);
+        group_ends.push_back(primes.size());
+
+        for (uint64_t p : group_products) {
+            group_divisors.push_back(mpn_limb_divisor(p));
+        }
+    }
+};
+
+static const SmallPrimes &small_primes() {
+    static const SmallPrimes table;
+    return table;
+}
+
+// Result of trial division: composite, prime, or undecided
+enum class TrialResult { COMPOSITE, PRIME, UNKNOWN };
+
+static TrialResult trial_division(const BigInt &n) {
+    BigIntView view(n);
+    if (view.size() <= 1 && view.get_bits(0) < 2) {
+        return TrialResult::COMPOSITE;
+    }
+    if ((view.get_bits(0) & 1) == 0) {
+        return view.size() == 1 && view.get_bits(0) == 2 ? TrialResult::PRIME : TrialResult::COMPOSITE;
+    }
+
+    const SmallPrimes &table = small_primes();
+    size_t begin = 0;
+    for (size_t g = 0; g < table.group_products.size(); ++g) {
+        uint64_t r = mpn_mod_1_preinv(view.data(), view.size(), table.group_divisors[g]);
+        for (size_t i = begin; i < table.group_ends[g]; ++i) {
+            if (r % table.primes[i] == 0) {
+                return (view.size() == 1 && view.get_bits(0) == table.primes[i])
+                    ? TrialResult::PRIME : TrialResult::COMPOSITE;
+            }
+        }
+        begin = table.group_ends[g];
+    }
+
+    // No factor below the table limit: anything below its square is prime
+    uint64_t limit = table.primes.back() + 2;
+    if (view.size() == 1 && view.get_bits(0) < limit * limit) {
+        return TrialResult::PRIME;
+    }
+    return TrialResult::UNKNOWN;
+}
+
+// One Miller-Rabin round: n - 1 = d * 2^s, all values in Montgomery form
+static bool miller_rabin(const MontgomeryContext &ctx, const uint64_t *base,
+                         const BigInt &d, unsigned s, const uint64_t *one, const uint64_t *minus_one) {
+    size_t n = ctx.limbs();
+    std::vector<uint64_t> x(n);
+    ctx.pow(x.data(), base, d);
+    if (ctx.equal(x.data(), one) || ctx.equal(x.data(), minus_one)) {
+        return true;
+    }
+    for (unsigned r = 1; r < s; ++r) {
+        ctx.mul(x.data(), x.data(), x.data());
+        if (ctx.equal(x.data(), minus_one)) {
+            return true;
+        }
+        if (ctx.equal(x.data(), one)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+// Jacobi symbol (a / m) for odd m
+static int jacobi_small(uint64_t a, uint64_t m) {
+    int t = 1;
+    a %= m;
+    while (a != 0) {
+        while ((a & 1) == 0) {
+            a >>= 1;
+            uint64_t r = m % 8;
+            if (r == 3 || r == 5) {
+                t = -t;
+            }
+        }
+        std::swap(a, m);
+        if (a % 4 == 3 && m % 4 == 3) {
+            t = -t;
+        }
+        a %= m;
+    }
+    return m == 1 ? t : 0;
+}
+
+// Jacobi symbol (d / n) for a small signed d and a large odd n > 0
+static int jacobi(int64_t d, const BigInt &n) {
+    BigIntView view(n);
+    uint64_t n_mod8 = view.get_bits(0) % 8;
+    int t = 1;
+    uint64_t a = d < 0 ? 0 - static_cast<uint64_t>(d) : static_cast<uint64_t>(d);
+
+    // (-1 / n) = 1 iff n = 1 mod 4
+    if (d < 0 && n_mod8 % 4 == 3) {
+        t = -t;
+    }
+    // (2 / n) = 1 iff n = +-1 mod 8
+    while (a != 0 && (a & 1) == 0) {
+        a >>= 1;
+        if (n_mod8 == 3 || n_mod8 == 5) {
+            t = -t;
+        }
+    }
+    if (a == 0) {
+        return 0;
+    }
+    // Quadratic reciprocity, then reduce n modulo the small value
+    if (a % 4 == 3 && n_mod8 % 4 == 3) {
+        t = -t;
+    }
+    return t * jacobi_small(mod_small(view, a), a);
+}
+
+// Strong Lucas probable prime test with Selfridge's parameters
+// (P = 1, Q = (1 - D) / 4, D the first of 5, -7, 9, -11, ... with (D / n) = -1)
+static bool strong_lucas(const BigInt &n) {
+    int64_t d = 5;
+    for (int tries = 0; ; ++tries) {
+        int j = jacobi(d, n);
+        if (j == -1) {
+            break;
+        }
+        if (j == 0 && BigInt(static_cast<uint64_t>(d < 0 ? -d : d)) != n) {
+            return false;  // d shares a factor with n
+        }
+        // No suitable D exists for perfect squares; rule them out once
+        // the search runs longer than it does for almost every n
+        if (tries == 8) {
+            BigInt root = isqrt(n);
+            if (root * root == n) {
+                return false;
+            }
+        }
+        d = d > 0 ? -(d + 2) : -(d - 2);
+    }
+    int64_t q = (1 - d) / 4;
+
+    MontgomeryContext ctx(n);
+    size_t len = ctx.limbs();
+    std::vector<uint64_t> u(len), v(len), qk(len), q_m(len), d_m(len), t(len);
+    ctx.to_mont(q_m.data(), BigInt(static_cast<uint64_t>(q < 0 ? -q : q), q < 0));
+    ctx.to_mont(d_m.data(), BigInt(static_cast<uint64_t>(d < 0 ? -d : d), d < 0));
+
+    // n + 1 = k * 2^s with k odd
+    BigInt n_plus_1 = n + 1;
+    size_t s = n_plus_1.countr_zero();
+    BigInt k = n_plus_1 >> s;
+
+    // U_1 = 1, V_1 = P = 1, Q^1 = Q; then walk the remaining bits of k
+    ctx.one(u.data());
+    ctx.one(v.data());
+    qk = q_m;
+    for (size_t b = k.bit_length() - 1; b-- > 0; ) {
+        // Doubling: U_2m = U_m V_m, V_2m = V_m^2 - 2 Q^m
+        ctx.mul(u.data(), u.data(), v.data());
+        ctx.mul(v.data(), v.data(), v.data());
+        ctx.add(t.data(), qk.data(), qk.data());
+        ctx.sub(v.data(), v.data(), t.data());
+        ctx.mul(qk.data(), qk.data(), qk.data());
+
+        if (k.is_bit_set(b)) {
+            // Increment: U_m+1 = (U_m + V_m) / 2, V_m+1 = (D U_m + V_m) / 2
+            ctx.mul(t.data(), d_m.data(), u.data());
+            ctx.add(u.data(), u.data(), v.data());
+            ctx.half(u.data(), u.data());
+            ctx.add(v.data(), t.data(), v.data());
+            ctx.half(v.data(), v.data());
+            ctx.mul(qk.data(), qk.data(), q_m.data());
+        }
+    }
+
+    if (ctx.is_zero(u.data())) {
+        return true;
+    }
+    for (unsigned r = 0; r < s; ++r) {
+        if (ctx.is_zero(v.data())) {
+            return true;
+        }
+        ctx.mul(v.data(), v.data(), v.data());
+        ctx.add(t.data(), qk.data(), qk.data());
+        ctx.sub(v.data(), v.data(), t.data());
+        ctx.mul(qk.data(), qk.data(), qk.data());
+    }
+    return false;
+}
+
+bool is_probable_prime(const BigInt &n, unsigned rounds) {
+    if (n.is_negative()) {
+        return false;
+    }
+    TrialResult trial = trial_division(n);
+    if (trial != TrialResult::UNKNOWN) {
+        return trial == TrialResult::PRIME;
+    }
+
+    MontgomeryContext ctx(n);
+    size_t len = ctx.limbs();
+    std::vector<uint64_t> one(len), minus_one(len), base(len);
+    ctx.one(one.data());
+    ctx.sub(minus_one.data(), minus_one.data(), one.data());
+
+    // n - 1 = d * 2^s with d odd
+    BigInt n_minus_1 = n - 1;
+    size_t s = n_minus_1.countr_zero();
+    BigInt d = n_minus_1 >> s;
+
+    ctx.to_mont(base.data(), BigInt(2));
+    if (!miller_rabin(ctx, base.data(), d, s, one.data(), minus_one.data())) {
+        return false;
+    }
+    if (!strong_lucas(n)) {
+        return false;
+    }
+
+    // Extra rounds with bases drawn from a generator seeded by n, so the
+    // answer for a given n is reproducible
+    std::mt19937_64 rng(BigIntView(n).get_bits(0) ^ 0x9E3779B97F4A7C15ULL);
+    std::vector<uint64_t> random_limbs(len);
+    for (unsigned i = 0; i < rounds; ) {
+        for (uint64_t &limb : random_limbs) {
+            limb = rng();
+        }
+        ctx.to_mont(base.data(), BigIntView(random_limbs.data(), len));
+        if (ctx.is_zero(base.data()) || ctx.equal(base.data(), one.data())
+            || ctx.equal(base.data(), minus_one.data())) {
+            continue;
+        }
+        if (!miller_rabin(ctx, base.data(), d, s, one.data(), minus_one.data())) {
+            return false;
+        }
+        ++i;
+    }
+    return true;
+}
+
+BigInt next_prime(const BigInt &n, unsigned rounds) {
+    if (n < 2) {
+        return BigInt(2);
+    }
+
+    BigInt candidate = n + 1;
+    if (!candidate.is_bit_set(0)) {
+        candidate = candidate + 1;
+    }
+
+    // Small candidates: trial division decides them outright
+    const SmallPrimes &table = small_primes();
+    if (candidate <= BigInt(table.primes.back())) {
+        while (!is_probable_prime(candidate, rounds)) {
+            candidate = candidate + 2;
+        }
+        return candidate;
+    }
+
+    // Sieve: keep candidate mod p for every small prime, and skip the
+    // offsets that make any of them zero
+    std::vector<uint64_t> residues(table.primes.size());
+    for (size_t i = 0; i < table.primes.size(); ++i) {
+        residues[i] = mod_small(candidate, table.primes[i]);
+    }
+    for (uint64_t offset = 0; ; offset += 2) {
+        bool sieved_out = false;
+        for (size_t i = 0; i < table.primes.size() && !sieved_out; ++i) {
+            sieved_out = (residues[i] + offset) % table.primes[i] == 0;
+        }
+        if (!sieved_out) {
+            BigInt c = candidate + BigInt(offset);
+            if (is_probable_prime(c, rounds)) {
+                return c;
+            }
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef BIGINT_MATH_H
+#define BIGINT_MATH_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "bigint.h"
+
+//! @file
+//! Number-theoretic and combinatorial functions on BigInt values.
+
+//! Compute the product of a sequence of values using a balanced
+//! product tree, so that each multiplication is between operands of
+//! similar size (and can use the Karatsuba tier). Large trees are
+//! split across threads, up to `BigInt::get_max_threads()`.
+//!
+//! @param vals pointer to the values to multiply
+//! @param n number of values
+//! @return the product (1 if `n` is 0)
+BigInt product(const BigInt *vals, size_t n);
+
+//! Compute the product of a vector of values (see `product(const BigInt *, size_t)`).
+//!
+//! @param vals the values to multiply
+//! @return the product (1 if `vals` is empty)
+BigInt product(const std::vector<BigInt> &vals);
+
+//! Compute n! by multiplying the odd parts of 1..n with a product tree
+//! and shifting in the powers of two at the end.
+//!
+//! @param n the argument
+//! @return n factorial
+BigInt factorial(uint64_t n);
+
+//! Compute the binomial coefficient "n choose k". For k comparable to
+//! n, this multiplies its prime factorization (Legendre's formula)
+//! with a product tree and needs no division; for small k it divides
+//! n (n-1) ... (n-k+1) by k! instead, which needs no sieve up to n.
+//!
+//! @param n size of the set
+//! @param k size of the subsets
+//! @return the binomial coefficient (0 if `k > n`)
+BigInt binomial(uint64_t n, uint64_t k);
+
+//! Compute the integer square root: the largest r with r * r <= n.
+//!
+//! @param n the argument (must be non-negative)
+//! @return floor(sqrt(n))
+//! @throw std::invalid_argument if `n` is negative
+BigInt isqrt(const BigInt &n);
+
+//! Compute the greatest common divisor of two values with the binary
+//! GCD algorithm, in place on scratch limb arrays: each step subtracts
+//! the smaller odd value from the larger and shifts out the trailing
+//! zeros a limb at a time. When one value is much longer than the
+//! other, a single division shrinks it first.
+//!
+//! @param a the first value
+//! @param b the second value
+//! @return the (non-negative) GCD of `a` and `b`; 0 if both are 0
+BigInt gcd(const BigInt &a, const BigInt &b);
+
+//! Probabilistic primality test. After trial division by a table of
+//! small primes (using one single-limb remainder per group of primes),
+//! runs the Baillie-PSW test: a Miller-Rabin test to base 2 and a
+//! strong Lucas test (Selfridge parameters), both in Montgomery form.
+//! No composite passing Baillie-PSW is known. `rounds` further
+//! Miller-Rabin tests with pseudo-random bases (chosen
+//! deterministically from `n`) can be added for extra assurance.
+//!
+//! @param n the value to test (values below 2 are never prime)
+//! @param rounds number of extra Miller-Rabin rounds
+//! @return true if `n` is (probably) prime, false if it is composite
+bool is_probable_prime(const BigInt &n, unsigned rounds = 4);
+
+//! Find the smallest probable prime greater than `n`. Candidates are
+//! sieved incrementally against the small-prime table, so only
+//! candidates with no small factor reach `is_probable_prime`.
+//!
+//! @param n the starting point
+//! @param rounds extra Miller-Rabin rounds (see `is_probable_prime`)
+//! @return the next (probable) prime after `n`
+BigInt next_prime(const BigInt &n, unsigned rounds = 4);
+
+#endif // BIGINT_MATH_H
@@ -0,0 +1,254 @@
+#include "bigint_mmap.h"
+#include "bigint_mpn.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Mapped limbs are used in place, so the file layout (little-endian
+// limbs) must match the host's byte order
+static void check_little_endian() {
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+    throw std::runtime_error("MappedBigInt requires a little-endian host");
+#endif
+}
+
+static std::runtime_error io_error(const std::string &what, const std::string &path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+// Map the whole of an open file descriptor, then close it
+static uint8_t *map_fd(int fd, size_t len, bool writable, const std::string &path) {
+    int prot = PROT_READ | (writable ? PROT_WRITE : 0);
+    void *p = mmap(nullptr, len, prot, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        throw io_error("Cannot map", path);
+    }
+    return static_cast<uint8_t *>(p);
+}
+
+// Tell the kernel how the n limbs at `limbs` are about to be read:
+// MADV_SEQUENTIAL for a single streaming pass (read ahead, and drop
+// pages once passed), MADV_NORMAL for limbs that are read again. Only
+// a hint, and harmless for limbs that aren't mapped from a file.
+static void advise(const uint64_t *limbs, size_t n, int advice) {
+    if (n == 0) {
+        return;
+    }
+    uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t begin = reinterpret_cast<uintptr_t>(limbs) & ~(page - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(limbs + n);
+    madvise(reinterpret_cast<void *>(begin), end - begin, advice);
+}
+
+MappedBigInt::MappedBigInt(uint8_t *map, size_t map_len, bool writable)
+    : map(map), map_len(map_len), writable(writable) {}
+
+MappedBigInt::MappedBigInt(MappedBigInt &&other)
+    : map(other.map), map_len(other.map_len), writable(other.writable) {
+    other.map = nullptr;
+    other.map_len = 0;
+}
+
+MappedBigInt &MappedBigInt::operator=(MappedBigInt &&rhs) {
+    if (this != &rhs) {
+        if (map) {
+            munmap(map, map_len);
+        }
+        map = rhs.map;
+        map_len = rhs.map_len;
+        writable = rhs.writable;
+        rhs.map = nullptr;
+        rhs.map_len = 0;
+    }
+    return *this;
+}
+
+MappedBigInt::~MappedBigInt() {
+    if (map) {
+        munmap(map, map_len);
+    }
+}
+
+MappedBigInt MappedBigInt::create(const std::string &path, size_t capacity) {
+    check_little_endian();
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw io_error("Cannot create", path);
+    }
+    size_t len = 8 * (capacity + 1);
+    if (ftruncate(fd, static_cast<off_t>(len)) != 0) {
+        ::close(fd);
+        throw io_error("Cannot size", path);
+    }
+
+    // A freshly extended file reads as zeros: limb count 0, non-negative
+    return MappedBigInt(map_fd(fd, len, true, path), len, true);
+}
+
+MappedBigInt MappedBigInt::create(const std::string &path, const BigIntView &val, size_t capacity) {
+    MappedBigInt result = create(path, std::max(capacity, val.size()));
+    std::copy(val.data(), val.data() + val.size(), result.limbs());
+    result.set_header(val.size(), val.is_negative());
+    return result;
+}
+
+MappedBigInt MappedBigInt::open(const std::string &path, bool writable) {
+    check_little_endian();
+
+    int fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+    if (fd < 0) {
+        throw io_error("Cannot open", path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw io_error("Cannot stat", path);
+    }
+    size_t len = static_cast<size_t>(st.st_size);
+    if (len < 8 || len % 8 != 0) {
+        ::close(fd);
+        throw std::invalid_argument("Not a serialized BigInt file: " + path);
+    }
+
+    MappedBigInt result(map_fd(fd, len, writable, path), len, writable);
+    if ((*reinterpret_cast<const uint64_t *>(result.map) >> 1) > result.capacity()) {
+        throw std::invalid_argument("Truncated BigInt file: " + path);
+    }
+    return result;
+}
+
+void MappedBigInt::set_header(size_t count, bool negative) {
+    // Trim leading zero limbs so the header always holds the exact size
+    while (count > 0 && limbs()[count - 1] == 0) {
+        --count;
+    }
+    *reinterpret_cast<uint64_t *>(map) = (static_cast<uint64_t>(count) << 1)
+                                       | ((negative && count > 0) ? 1 : 0);
+}
+
+size_t MappedBigInt::capacity() const {
+    return map_len / 8 - 1;
+}
+
+BigIntView MappedBigInt::view() const {
+    uint64_t header = *reinterpret_cast<const uint64_t *>(map);
+    return BigIntView(limbs(), static_cast<size_t>(header >> 1), (header & 1) != 0);
+}
+
+BigInt MappedBigInt::to_bigint() const {
+    return view().to_bigint();
+}
+
+void MappedBigInt::sync() {
+    if (msync(map, map_len, MS_SYNC) != 0) {
+        throw std::runtime_error(std::string("Cannot sync mapped BigInt: ") + std::strerror(errno));
+    }
+}
+
+// Check that out can receive a result of `needed` limbs: writing
+// through a read-only mapping would crash rather than throw
+static void check_capacity(const MappedBigInt &out, size_t needed) {
+    if (!out.is_writable()) {
+        throw std::invalid_argument("MappedBigInt result was opened read-only");
+    }
+    if (out.capacity() < needed) {
+        throw std::invalid_argument("MappedBigInt capacity is too small for the result");
+    }
+}
+
+// Signed addition on magnitudes: same signs add, different signs
+// subtract the smaller magnitude from the larger one
+void MappedBigInt::add(MappedBigInt &out, const BigIntView &a, const BigIntView &b) {
+    size_t max_size = std::max(a.size(), b.size());
+    check_capacity(out, max_size + 1);
+    uint64_t *r = out.limbs();
+    advise(a.data(), a.size(), MADV_SEQUENTIAL);
+    advise(b.data(), b.size(), MADV_SEQUENTIAL);
+
+    // The kernels go from the low limb up, so r may be a's or b's limbs
+    if (a.is_negative() == b.is_negative()) {
+        const BigIntView &big = (a.size() >= b.size()) ? a : b;
+        const BigIntView &small = (a.size() >= b.size()) ? b : a;
+        r[max_size] = mpn_add(r, big.data(), big.size(), small.data(), small.size());
+        out.set_header(max_size + 1, a.is_negative());
+        return;
+    }
+
+    BigIntView abs_a(a.data(), a.size()), abs_b(b.data(), b.size());
+    const BigIntView &big = (abs_a >= abs_b) ? a : b;
+    const BigIntView &small = (abs_a >= abs_b) ? b : a;
+    mpn_sub(r, big.data(), big.size(), small.data(), small.size());
+    out.set_header(max_size, big.is_negative());
+}
+
+void MappedBigInt::sub(MappedBigInt &out, const BigIntView &a, const BigIntView &b) {
+    add(out, a, -b);
+}
+
+void MappedBigInt::shift_left(MappedBigInt &out, const BigIntView &a, unsigned n) {
+    if (a.is_negative()) {
+        throw std::invalid_argument("Cannot shift negative BigInt");
+    }
+
+    size_t words = n / 64;
+    unsigned bits = n % 64;
+    size_t result_size = a.size() + words + 1;
+    check_capacity(out, result_size);
+    uint64_t *r = out.limbs();
+    advise(a.data(), a.size(), MADV_SEQUENTIAL);
+
+    // Most significant limb first, so out may alias a
+    if (bits) {
+        r[result_size - 1] = mpn_lshift(r + words, a.data(), a.size(), bits);
+    } else {
+        std::copy_backward(a.data(), a.data() + a.size(), r + words + a.size());
+        r[result_size - 1] = 0;
+    }
+    std::fill(r, r + words, 0);
+    out.set_header(result_size, false);
+}
+
+void MappedBigInt::multiply(MappedBigInt &out, const BigIntView &a, const BigIntView &b,
+                            size_t block_limbs) {
+    size_t result_size = a.size() + b.size();
+    check_capacity(out, result_size);
+    if (block_limbs == 0) {
+        throw std::invalid_argument("Block size must be positive");
+    }
+
+    uint64_t *r = out.limbs();
+    std::fill(r, r + result_size, 0);
+
+    // Each block of a is read once, but all of b is read again for
+    // every block of a, so b's pages must not be dropped once passed
+    advise(a.data(), a.size(), MADV_SEQUENTIAL);
+    advise(b.data(), b.size(), MADV_NORMAL);
+    advise(r, result_size, MADV_NORMAL);
+
+    for (size_t ia = 0; ia < a.size(); ia += block_limbs) {
+        BigIntView a_block(a.data() + ia, std::min(block_limbs, a.size() - ia));
+
+        for (size_t jb = 0; jb < b.size(); jb += block_limbs) {
+            BigIntView b_block(b.data() + jb, std::min(block_limbs, b.size() - jb));
+            BigInt partial = a_block * b_block;
+            BigIntView p(partial);
+
+            // Accumulate into the window of out starting at limb ia + jb
+            uint64_t *w = r + ia + jb;
+            size_t room = result_size - ia - jb;
+            uint64_t carry = mpn_add_n(w, w, p.data(), p.size());
+            for (size_t k = p.size(); carry && k < room; ++k) {
+                carry = (++w[k] == 0);
+            }
+        }
+    }
+
+    out.set_header(result_size, a.is_negative() != b.is_negative());
+}
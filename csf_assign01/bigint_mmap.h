@@ -0,0 +1,141 @@
+#ifndef BIGINT_MMAP_H
+#define BIGINT_MMAP_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "bigint.h"
+
+//! @file
+//! Out-of-core arbitrary-precision integers stored in memory-mapped files.
+
+//! Class representing an arbitrary-precision integer whose limbs live
+//! in a memory-mapped file rather than in a `std::vector`, for values
+//! too large to keep comfortably in RAM. The file uses the fixed
+//! layout written by `BigInt::serialize` (a header word holding
+//! `(limb count << 1) | sign`, then little-endian limbs), so a mapped
+//! value can also be read with `BigInt::deserialize_view` and any
+//! serialized BigInt file can be opened as a MappedBigInt.
+//!
+//! The file is sized once, when it is created, to a fixed limb
+//! capacity. Results are written into a caller-provided MappedBigInt
+//! with enough capacity. Each operation walks the mapped limbs in order
+//! and tells the kernel which operands it streams through once (so
+//! they are read ahead) and which it reads again (so their pages are
+//! kept), so read-ahead and write-back see page-friendly access. `view()` gives a BigIntView that works with
+//! every read-only BigInt operation (`compare`, `to_hex`, etc.).
+class MappedBigInt {
+private:
+   uint8_t *map;
+   size_t map_len;
+   bool writable;
+
+   MappedBigInt(uint8_t *map, size_t map_len, bool writable);
+
+   uint64_t *limbs() { return reinterpret_cast<uint64_t *>(map + 8); }
+   const uint64_t *limbs() const { return reinterpret_cast<const uint64_t *>(map + 8); }
+   void set_header(size_t count, bool negative);
+
+public:
+  //! Create (or truncate) a file holding a zero value with room for
+  //! `capacity` limbs, and map it read/write.
+  //!
+  //! @param path path of the file to create
+  //! @param capacity maximum number of limbs the file can hold
+  //! @return the mapped value
+  //! @throw std::runtime_error if the file cannot be created or mapped
+  static MappedBigInt create(const std::string &path, size_t capacity);
+
+  //! Create a file holding a copy of `val` (with room for at least
+  //! `capacity` limbs) and map it read/write.
+  //!
+  //! @param path path of the file to create
+  //! @param val the initial value
+  //! @param capacity minimum limb capacity (the value's size is used if larger)
+  //! @return the mapped value
+  //! @throw std::runtime_error if the file cannot be created or mapped
+  static MappedBigInt create(const std::string &path, const BigIntView &val, size_t capacity = 0);
+
+  //! Map an existing file written by `create` or `BigInt::serialize`.
+  //!
+  //! @param path path of the file to open
+  //! @param writable if true, map the file read/write
+  //! @return the mapped value
+  //! @throw std::runtime_error if the file cannot be opened or mapped
+  //! @throw std::invalid_argument if the file is not a serialized BigInt
+  static MappedBigInt open(const std::string &path, bool writable = false);
+
+  MappedBigInt(MappedBigInt &&other);
+  MappedBigInt &operator=(MappedBigInt &&rhs);
+  MappedBigInt(const MappedBigInt &) = delete;
+  MappedBigInt &operator=(const MappedBigInt &) = delete;
+
+  //! Destructor: unmaps the file (its contents stay on disk).
+  ~MappedBigInt();
+
+  //! @return the maximum number of limbs this file can hold
+  size_t capacity() const;
+
+  //! @return true if the file is mapped read/write (so it can be the
+  //!         destination of an operation)
+  bool is_writable() const { return writable; }
+
+  //! @return a read-only view of the mapped value
+  BigIntView view() const;
+
+  //! Make an in-memory copy of the mapped value.
+  //!
+  //! @return a BigInt with the same value
+  BigInt to_bigint() const;
+
+  //! Flush modified pages to the file.
+  void sync();
+
+  //! Compute `out = a + b` by streaming over the limbs once.
+  //! `out` may view the same file as `a` or `b`.
+  //!
+  //! @param out destination (must have capacity for
+  //!            `max(a.size(), b.size()) + 1` limbs)
+  //! @param a left operand
+  //! @param b right operand
+  //! @throw std::invalid_argument if `out` is too small or read-only
+  static void add(MappedBigInt &out, const BigIntView &a, const BigIntView &b);
+
+  //! Compute `out = a - b` by streaming over the limbs once.
+  //! `out` may view the same file as `a` or `b`.
+  //!
+  //! @param out destination (must have capacity for
+  //!            `max(a.size(), b.size()) + 1` limbs)
+  //! @param a left operand
+  //! @param b right operand
+  //! @throw std::invalid_argument if `out` is too small or read-only
+  static void sub(MappedBigInt &out, const BigIntView &a, const BigIntView &b);
+
+  //! Compute `out = a << n`, streaming from the most significant limb
+  //! down so `out` may view the same file as `a`.
+  //!
+  //! @param out destination (must have capacity for `a.size() + n / 64 + 1` limbs)
+  //! @param a the (non-negative) value to shift
+  //! @param n number of bits to shift left by
+  //! @throw std::invalid_argument if `a` is negative, or `out` is too
+  //!        small or read-only
+  static void shift_left(MappedBigInt &out, const BigIntView &a, unsigned n);
+
+  //! Compute `out = a * b` with a blocked algorithm: the operands are
+  //! split into blocks of `block_limbs` limbs, each pair of blocks is
+  //! multiplied in memory (using the Karatsuba/parallel tiers of
+  //! `BigInt::operator*`), and the partial product is accumulated into
+  //! a sliding window of `out`. Only a few blocks are resident at a
+  //! time; each block of `a` is read once and `b` once per block of `a`.
+  //! `out` must not view the same file as `a` or `b`.
+  //!
+  //! @param out destination (must have capacity for `a.size() + b.size()` limbs)
+  //! @param a left operand
+  //! @param b right operand
+  //! @param block_limbs block size in limbs (default: 1M limbs = 8 MiB)
+  //! @throw std::invalid_argument if `out` is too small or read-only
+  static void multiply(MappedBigInt &out, const BigIntView &a, const BigIntView &b,
+                       size_t block_limbs = 1 << 20);
+};
+
+#endif // BIGINT_MMAP_H
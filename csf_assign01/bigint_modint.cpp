@@ -0,0 +1,84 @@
+#include "bigint_modint.h"
+#include <stdexcept>
+
+ModInt::ModInt(const std::shared_ptr<const MontgomeryContext> &ctx)
+    : ctx(ctx), val(ctx->limbs(), 0) {}
+
+ModInt::ModInt(const std::shared_ptr<const MontgomeryContext> &ctx, const BigIntView &val)
+    : ctx(ctx) {
+    if (!ctx) {
+        throw std::invalid_argument("ModInt needs a Montgomery context");
+    }
+    this->val.resize(ctx->limbs());
+    ctx->to_mont(this->val.data(), val);
+}
+
+std::shared_ptr<const MontgomeryContext> ModInt::context(const BigInt &modulus) {
+    return std::make_shared<const MontgomeryContext>(modulus);
+}
+
+void ModInt::check_same(const ModInt &rhs) const {
+    if (ctx != rhs.ctx && ctx->modulus() != rhs.ctx->modulus()) {
+        throw std::invalid_argument("ModInt operands have different moduli");
+    }
+}
+
+BigInt ModInt::value() const {
+    return ctx->from_mont(val.data());
+}
+
+ModInt &ModInt::operator+=(const ModInt &rhs) {
+    check_same(rhs);
+    ctx->add(val.data(), val.data(), rhs.val.data());
+    return *this;
+}
+
+ModInt &ModInt::operator-=(const ModInt &rhs) {
+    check_same(rhs);
+    ctx->sub(val.data(), val.data(), rhs.val.data());
+    return *this;
+}
+
+ModInt &ModInt::operator*=(const ModInt &rhs) {
+    check_same(rhs);
+    ctx->mul(val.data(), val.data(), rhs.val.data());
+    return *this;
+}
+
+ModInt ModInt::operator+(const ModInt &rhs) const {
+    check_same(rhs);
+    ModInt result(ctx);
+    ctx->add(result.val.data(), val.data(), rhs.val.data());
+    return result;
+}
+
+ModInt ModInt::operator-(const ModInt &rhs) const {
+    check_same(rhs);
+    ModInt result(ctx);
+    ctx->sub(result.val.data(), val.data(), rhs.val.data());
+    return result;
+}
+
+ModInt ModInt::operator*(const ModInt &rhs) const {
+    check_same(rhs);
+    ModInt result(ctx);
+    ctx->mul(result.val.data(), val.data(), rhs.val.data());
+    return result;
+}
+
+ModInt ModInt::operator-() const {
+    ModInt result(ctx);
+    ctx->sub(result.val.data(), result.val.data(), val.data());
+    return result;
+}
+
+ModInt ModInt::pow(const BigIntView &exp) const {
+    ModInt result(ctx);
+    ctx->pow(result.val.data(), val.data(), exp);
+    return result;
+}
+
+bool ModInt::operator==(const ModInt &rhs) const {
+    check_same(rhs);
+    return ctx->equal(val.data(), rhs.val.data());
+}
@@ -0,0 +1,188 @@
+#ifndef BIGINT_MODINT_H
+#define BIGINT_MODINT_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "bigint.h"
+#include "bigint_mpn.h"
+#include "bigint_montgomery.h"
+
+//! @file
+//! Integers modulo N, kept in Montgomery form for their whole lifetime.
+
+//! Class representing an integer modulo an odd N chosen at run time.
+//! The value is stored in Montgomery form (see `MontgomeryContext`)
+//! from construction until `value()` is called, so chains of additions
+//! and multiplications never convert in or out of that form and never
+//! divide. Every value refers to a shared context for its modulus;
+//! combining values with different contexts is an error (values from
+//! separate contexts with the same modulus are accepted).
+class ModInt {
+private:
+   std::shared_ptr<const MontgomeryContext> ctx;
+   std::vector<uint64_t> val;   // Montgomery form, ctx->limbs() limbs
+
+   // Zero, with the given context
+   explicit ModInt(const std::shared_ptr<const MontgomeryContext> &ctx);
+
+   void check_same(const ModInt &rhs) const;
+
+public:
+  //! Constructor: `val` reduced modulo the context's modulus.
+  //!
+  //! @param ctx the context for the modulus (must not be null)
+  //! @param val the value (of any size or sign)
+  //! @throw std::invalid_argument if `ctx` is null
+  ModInt(const std::shared_ptr<const MontgomeryContext> &ctx, const BigIntView &val);
+
+  //! Create a context for use with this class.
+  //!
+  //! @param modulus the modulus
+  //! @return the shared context
+  //! @throw std::invalid_argument if `modulus` is not odd and positive
+  static std::shared_ptr<const MontgomeryContext> context(const BigInt &modulus);
+
+  //! @return the context of this value
+  const std::shared_ptr<const MontgomeryContext> &get_context() const { return ctx; }
+
+  //! @return the modulus
+  const BigInt &modulus() const { return ctx->modulus(); }
+
+  //! @return the value, in [0, modulus) (this is the only conversion
+  //!         out of Montgomery form)
+  BigInt value() const;
+
+  //! @return true if the value is zero
+  bool is_zero() const { return ctx->is_zero(val.data()); }
+
+  //! Modular arithmetic.
+  //!
+  //! @param rhs the right-hand side value
+  //! @return the result
+  //! @throw std::invalid_argument if `rhs` has a different modulus
+  ModInt operator+(const ModInt &rhs) const;
+  ModInt operator-(const ModInt &rhs) const;
+  ModInt operator*(const ModInt &rhs) const;
+
+  //! In-place modular arithmetic. Nothing is allocated, except by `*=`
+  //! for moduli wider than `MontgomeryContext::MUL_STACK_LIMBS` limbs
+  //! (1024 bits), which allocates a scratch buffer on each call.
+  //!
+  //! @param rhs the right-hand side value
+  //! @return a reference to this value
+  //! @throw std::invalid_argument if `rhs` has a different modulus
+  ModInt &operator+=(const ModInt &rhs);
+  ModInt &operator-=(const ModInt &rhs);
+  ModInt &operator*=(const ModInt &rhs);
+
+  //! @return the negated value
+  ModInt operator-() const;
+
+  //! @param exp the exponent (must be non-negative)
+  //! @return this value raised to `exp`
+  //! @throw std::invalid_argument if `exp` is negative
+  ModInt pow(const BigIntView &exp) const;
+
+  //! @throw std::invalid_argument if `rhs` has a different modulus
+  bool operator==(const ModInt &rhs) const;
+  bool operator!=(const ModInt &rhs) const { return !(*this == rhs); }
+};
+
+//! Class representing an integer modulo an odd 64-bit modulus M fixed
+//! at compile time, in Montgomery form with R = 2^64. The Montgomery
+//! constants are compile-time constants and each value is a single
+//! word, so arithmetic compiles down to a few inline multiplications
+//! with no allocation and no division.
+template <uint64_t M>
+class StaticModInt {
+  static_assert(M % 2 == 1, "StaticModInt modulus must be odd");
+
+private:
+   uint64_t v;   // Montgomery form: value * 2^64 mod M
+
+   static constexpr uint64_t NINV = mpn_neg_inverse_limb(M);
+   static constexpr uint64_t R_MOD = (0 - M) % M;   // 2^64 mod M
+   static constexpr uint64_t R2 = static_cast<uint64_t>((unsigned __int128) R_MOD * R_MOD % M);
+
+   // t / 2^64 mod M, for t < M * 2^64
+   static uint64_t redc(unsigned __int128 t) {
+       uint64_t q = static_cast<uint64_t>(t) * NINV;
+       // t + q * M has a zero low word, which carries out unless t's is zero
+       unsigned __int128 qm = (unsigned __int128) q * M;
+       unsigned __int128 r = (t >> 64) + (qm >> 64) + (static_cast<uint64_t>(t) != 0);
+       return static_cast<uint64_t>(r >= M ? r - M : r);
+   }
+
+   static StaticModInt from_mont(uint64_t v) {
+       StaticModInt result;
+       result.v = v;
+       return result;
+   }
+
+public:
+  //! Default constructor: zero.
+  StaticModInt() : v(0) {}
+
+  //! Constructor from a word, reduced modulo M.
+  //!
+  //! @param x the value
+  StaticModInt(uint64_t x) : v(redc((unsigned __int128) (x % M) * R2)) {}
+
+  //! Constructor from a BigInt (of any size or sign), reduced modulo M.
+  //!
+  //! @param x the value
+  explicit StaticModInt(const BigIntView &x) : StaticModInt(mpn_mod_1(x.data(), x.size(), M)) {
+      if (x.is_negative()) {
+          *this = -*this;
+      }
+  }
+
+  //! @return the modulus M
+  static constexpr uint64_t modulus() { return M; }
+
+  //! @return the value, in [0, M)
+  uint64_t value() const { return redc(v); }
+
+  //! @return true if the value is zero
+  bool is_zero() const { return v == 0; }
+
+  StaticModInt &operator+=(StaticModInt rhs) {
+      uint64_t s = v + rhs.v;
+      v = (s < v || s >= M) ? s - M : s;
+      return *this;
+  }
+
+  StaticModInt &operator-=(StaticModInt rhs) {
+      v = (v >= rhs.v) ? v - rhs.v : v - rhs.v + M;
+      return *this;
+  }
+
+  StaticModInt &operator*=(StaticModInt rhs) {
+      v = redc((unsigned __int128) v * rhs.v);
+      return *this;
+  }
+
+  StaticModInt operator+(StaticModInt rhs) const { return StaticModInt(*this) += rhs; }
+  StaticModInt operator-(StaticModInt rhs) const { return StaticModInt(*this) -= rhs; }
+  StaticModInt operator*(StaticModInt rhs) const { return StaticModInt(*this) *= rhs; }
+  StaticModInt operator-() const { return from_mont(v ? M - v : 0); }
+
+  //! @param exp the exponent
+  //! @return this value raised to `exp`
+  StaticModInt pow(uint64_t exp) const {
+      StaticModInt result = from_mont(R_MOD), base = *this;
+      for (; exp; exp >>= 1) {
+          if (exp & 1) {
+              result *= base;
+          }
+          base *= base;
+      }
+      return result;
+  }
+
+  bool operator==(StaticModInt rhs) const { return v == rhs.v; }
+  bool operator!=(StaticModInt rhs) const { return v != rhs.v; }
+};
+
+#endif // BIGINT_MODINT_H
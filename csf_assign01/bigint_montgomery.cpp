@@ -0,0 +1,172 @@
+#include "bigint_montgomery.h"
+#include "bigint_mpn.h"
+#include <stdexcept>
+#include <algorithm>
+
+MontgomeryContext::MontgomeryContext(const BigInt &modulus)
+    : mod_value(modulus) {
+
+    if (modulus.is_negative() || modulus.is_zero() || (modulus.get_bits(0) & 1) == 0) {
+        throw std::invalid_argument("Montgomery modulus must be odd and positive");
+    }
+
+    BigIntView view(modulus);
+    mod.assign(view.data(), view.data() + view.size());
+    size_t n = mod.size();
+
+    ninv = mpn_neg_inverse_limb(mod[0]);
+    r_mod.resize(n);
+    r2.resize(n);
+    mpn_pow2_mod(r_mod.data(), 64 * n, mod.data(), n);
+    mpn_pow2_mod(r2.data(), 128 * n, mod.data(), n);
+}
+
+// Coarsely Integrated Operand Scanning: interleave the rows of a * b
+// with the reduction steps, keeping an (n + 2)-limb accumulator
+void MontgomeryContext::mul(uint64_t *r, const uint64_t *a, const uint64_t *b) const {
+    size_t n = mod.size();
+
+    // Keep the accumulator on the stack for the usual small moduli:
+    // this is the inner step of every chained modular computation
+    uint64_t stack_buf[MUL_STACK_LIMBS + 2];
+    std::vector<uint64_t> heap_buf;
+    uint64_t *t = stack_buf;
+    if (n > MUL_STACK_LIMBS) {
+        heap_buf.resize(n + 2);
+        t = heap_buf.data();
+    }
+    std::fill(t, t + n + 2, 0);
+
+    for (size_t i = 0; i < n; ++i) {
+        // t += a * b[i]
+        uint64_t carry = mpn_addmul_1(t, a, n, b[i]);
+        unsigned __int128 s = (unsigned __int128) t[n] + carry;
+        t[n] = (uint64_t) s;
+        t[n + 1] = (uint64_t) (s >> 64);
+
+        // t = (t + q * N) / 2^64, with q chosen so the low limb cancels
+        uint64_t q = t[0] * ninv;
+        unsigned __int128 p = (unsigned __int128) q * mod[0] + t[0];
+        carry = (uint64_t) (p >> 64);
+        for (size_t j = 1; j < n; ++j) {
+            p = (unsigned __int128) q * mod[j] + t[j] + carry;
+            t[j - 1] = (uint64_t) p;
+            carry = (uint64_t) (p >> 64);
+        }
+        s = (unsigned __int128) t[n] + carry;
+        t[n - 1] = (uint64_t) s;
+        t[n] = t[n + 1] + (uint64_t) (s >> 64);
+    }
+
+    // t < 2N: one conditional subtraction brings it below N
+    if (t[n] || mpn_cmp(t, mod.data(), n) >= 0) {
+        mpn_sub_n(t, t, mod.data(), n);
+    }
+    std::copy(t, t + n, r);
+}
+
+void MontgomeryContext::add(uint64_t *r, const uint64_t *a, const uint64_t *b) const {
+    size_t n = mod.size();
+    uint64_t carry = mpn_add_n(r, a, b, n);
+    if (carry || mpn_cmp(r, mod.data(), n) >= 0) {
+        mpn_sub_n(r, r, mod.data(), n);
+    }
+}
+
+void MontgomeryContext::sub(uint64_t *r, const uint64_t *a, const uint64_t *b) const {
+    size_t n = mod.size();
+    if (mpn_sub_n(r, a, b, n)) {
+        mpn_add_n(r, r, mod.data(), n);
+    }
+}
+
+void MontgomeryContext::half(uint64_t *r, const uint64_t *a) const {
+    size_t n = mod.size();
+    // a odd: (a + N) / 2, keeping the carry as the new top bit
+    uint64_t top = 0;
+    if (a[0] & 1) {
+        top = mpn_add_n(r, a, mod.data(), n);
+    } else {
+        std::copy(a, a + n, r);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t next = (i + 1 < n) ? r[i + 1] : top;
+        r[i] = (r[i] >> 1) | (next << 63);
+    }
+}
+
+void MontgomeryContext::one(uint64_t *r) const {
+    std::copy(r_mod.begin(), r_mod.end(), r);
+}
+
+void MontgomeryContext::to_mont(uint64_t *r, const BigIntView &a) const {
+    size_t n = mod.size();
+    std::vector<uint64_t> acc(n, 0), chunk(n);
+
+    // Horner over n-limb chunks c_i (each < R, which mul accepts as the
+    // left operand): acc = acc * R + c_i, all in Montgomery form, where
+    // multiplying a Montgomery value by R is mul(acc, R^2)
+    size_t chunks = (a.size() + n - 1) / n;
+    for (size_t c = chunks; c-- > 0; ) {
+        for (size_t l = 0; l < n; ++l) {
+            chunk[l] = a.get_bits(c * n + l);
+        }
+        mul(acc.data(), acc.data(), r2.data());
+        mul(chunk.data(), chunk.data(), r2.data());
+        add(acc.data(), acc.data(), chunk.data());
+    }
+
+    if (a.is_negative()) {
+        std::vector<uint64_t> zero(n, 0);
+        sub(acc.data(), zero.data(), acc.data());
+    }
+    std::copy(acc.begin(), acc.end(), r);
+}
+
+BigInt MontgomeryContext::from_mont(const uint64_t *a) const {
+    size_t n = mod.size();
+    std::vector<uint64_t> unit(n, 0), x(n);
+    unit[0] = 1;
+    mul(x.data(), a, unit.data());
+    return BigIntView(x.data(), n).to_bigint();
+}
+
+void MontgomeryContext::pow(uint64_t *r, const uint64_t *base, const BigIntView &exp) const {
+    if (exp.is_negative()) {
+        throw std::invalid_argument("Negative exponent");
+    }
+    size_t n = mod.size();
+
+    // table[i] = base^i for 4-bit windows
+    std::vector<uint64_t> table(16 * n);
+    one(table.data());
+    std::copy(base, base + n, table.data() + n);
+    for (size_t i = 2; i < 16; ++i) {
+        mul(table.data() + i * n, table.data() + (i - 1) * n, base);
+    }
+
+    std::vector<uint64_t> acc(n);
+    one(acc.data());
+    bool started = false;  // skip squaring 1 for the leading zero windows
+    for (size_t w = 16 * exp.size(); w-- > 0; ) {
+        unsigned digit = (exp.get_bits(w / 16) >> (4 * (w % 16))) & 0xF;
+        if (started) {
+            for (int k = 0; k < 4; ++k) {
+                mul(acc.data(), acc.data(), acc.data());
+            }
+        }
+        if (digit) {
+            mul(acc.data(), acc.data(), table.data() + digit * n);
+            started = true;
+        }
+    }
+    std::copy(acc.begin(), acc.end(), r);
+}
+
+bool MontgomeryContext::is_zero(const uint64_t *a) const {
+    return std::all_of(a, a + mod.size(), [](uint64_t x) { return x == 0; });
+}
+
+bool MontgomeryContext::equal(const uint64_t *a, const uint64_t *b) const {
+    return std::equal(a, a + mod.size(), b);
+}
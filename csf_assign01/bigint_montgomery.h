@@ -0,0 +1,93 @@
+#ifndef BIGINT_MONTGOMERY_H
+#define BIGINT_MONTGOMERY_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "bigint.h"
+
+//! @file
+//! Montgomery modular arithmetic on fixed-width limb arrays.
+
+//! Class holding the precomputed constants for Montgomery arithmetic
+//! modulo an odd modulus N of `limbs()` 64-bit limbs, with
+//! R = 2^(64 * limbs()). A value x is kept in Montgomery form as
+//! x * R mod N, in an array of exactly `limbs()` limbs (least
+//! significant first). In that form, modular multiplication needs
+//! no division, and addition, subtraction and halving work unchanged.
+//!
+//! All arithmetic member functions take caller-provided arrays,
+//! expect inputs already reduced below N, and allow the output to
+//! alias any input. A context is immutable after construction, so it
+//! can be shared between threads.
+class MontgomeryContext {
+private:
+   BigInt mod_value;
+   std::vector<uint64_t> mod;
+   uint64_t ninv;                // -N^(-1) mod 2^64
+   std::vector<uint64_t> r2;     // R^2 mod N
+   std::vector<uint64_t> r_mod;  // R mod N (the Montgomery form of 1)
+
+public:
+  //! Constructor.
+  //!
+  //! @param modulus the modulus N
+  //! @throw std::invalid_argument if `modulus` is not odd and positive
+  explicit MontgomeryContext(const BigInt &modulus);
+
+  //! @return the number of limbs in each value
+  size_t limbs() const { return mod.size(); }
+
+  //! @return the modulus N
+  const BigInt &modulus() const { return mod_value; }
+
+  //! Convert to Montgomery form. Any value (of any size or sign) is
+  //! accepted and reduced modulo N.
+  //!
+  //! @param r receives `limbs()` limbs: a * R mod N
+  //! @param a the value to convert
+  void to_mont(uint64_t *r, const BigIntView &a) const;
+
+  //! Convert from Montgomery form.
+  //!
+  //! @param a a value in Montgomery form
+  //! @return the value it represents, in [0, N)
+  BigInt from_mont(const uint64_t *a) const;
+
+  //! @param r receives the Montgomery form of 1
+  void one(uint64_t *r) const;
+
+  //! Largest modulus size (in limbs) for which `mul` keeps its
+  //! accumulator on the stack; wider moduli allocate it on each call.
+  static const size_t MUL_STACK_LIMBS = 16;
+
+  //! Montgomery product: r = a * b / R mod N (i.e., the product of
+  //! two values in Montgomery form, also in Montgomery form).
+  void mul(uint64_t *r, const uint64_t *a, const uint64_t *b) const;
+
+  //! Modular addition: r = a + b mod N.
+  void add(uint64_t *r, const uint64_t *a, const uint64_t *b) const;
+
+  //! Modular subtraction: r = a - b mod N.
+  void sub(uint64_t *r, const uint64_t *a, const uint64_t *b) const;
+
+  //! Modular halving: r = a / 2 mod N.
+  void half(uint64_t *r, const uint64_t *a) const;
+
+  //! Modular exponentiation with a 4-bit fixed window:
+  //! r = base^exp (all in Montgomery form).
+  //!
+  //! @param r receives the result
+  //! @param base the base, in Montgomery form
+  //! @param exp the exponent (must be non-negative)
+  //! @throw std::invalid_argument if `exp` is negative
+  void pow(uint64_t *r, const uint64_t *base, const BigIntView &exp) const;
+
+  //! @return true if `a` is zero (which is zero in both representations)
+  bool is_zero(const uint64_t *a) const;
+
+  //! @return true if `a` and `b` hold the same value
+  bool equal(const uint64_t *a, const uint64_t *b) const;
+};
+
+#endif // BIGINT_MONTGOMERY_H
@@ -0,0 +1,322 @@
+#include "bigint_mpn.h"
+#include <vector>
+#include <algorithm>
+
+uint64_t mpn_add_n(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        unsigned __int128 sum = (unsigned __int128) a[i] + b[i] + carry;
+        r[i] = (uint64_t) sum;
+        carry = (uint64_t) (sum >> 64);
+    }
+    return carry;
+}
+
+uint64_t mpn_add(uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b, size_t bn) {
+    uint64_t carry = mpn_add_n(r, a, b, bn);
+    return mpn_add_1(r + bn, a + bn, an - bn, carry);
+}
+
+uint64_t mpn_add_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b) {
+    uint64_t carry = b;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t sum = a[i] + carry;
+        carry = (sum < carry);
+        r[i] = sum;
+        if (!carry) {
+            // No carry left: copy the rest (nothing to do in place)
+            if (r != a) {
+                std::copy(a + i + 1, a + n, r + i + 1);
+            }
+            return 0;
+        }
+    }
+    return carry;
+}
+
+uint64_t mpn_sub_n(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t x = a[i], y = b[i];
+        r[i] = x - y - borrow;
+        // With an incoming borrow, x == y also wraps
+        borrow = (x < y) || (x == y && borrow);
+    }
+    return borrow;
+}
+
+uint64_t mpn_sub(uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b, size_t bn) {
+    uint64_t borrow = mpn_sub_n(r, a, b, bn);
+    return mpn_sub_1(r + bn, a + bn, an - bn, borrow);
+}
+
+uint64_t mpn_sub_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b) {
+    uint64_t borrow = b;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t x = a[i];
+        r[i] = x - borrow;
+        borrow = (x < borrow);
+        if (!borrow) {
+            if (r != a) {
+                std::copy(a + i + 1, a + n, r + i + 1);
+            }
+            return 0;
+        }
+    }
+    return borrow;
+}
+
+uint64_t mpn_neg(uint64_t *r, const uint64_t *a, size_t n) {
+    // Low zero limbs stay zero; the first nonzero limb is negated and
+    // the borrow it produces complements every limb above it
+    size_t i = 0;
+    for (; i < n && a[i] == 0; ++i) {
+        r[i] = 0;
+    }
+    if (i == n) {
+        return 0;
+    }
+    r[i] = 0 - a[i];
+    for (++i; i < n; ++i) {
+        r[i] = ~a[i];
+    }
+    return 1;
+}
+
+uint64_t mpn_mul_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        unsigned __int128 p = (unsigned __int128) a[i] * b + carry;
+        r[i] = (uint64_t) p;
+        carry = (uint64_t) (p >> 64);
+    }
+    return carry;
+}
+
+uint64_t mpn_addmul_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        // a * b + r + carry < 2^128, so this cannot overflow
+        unsigned __int128 p = (unsigned __int128) a[i] * b + r[i] + carry;
+        r[i] = (uint64_t) p;
+        carry = (uint64_t) (p >> 64);
+    }
+    return carry;
+}
+
+uint64_t mpn_submul_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+        unsigned __int128 p = (unsigned __int128) a[i] * b + borrow;
+        uint64_t lo = (uint64_t) p;
+        uint64_t x = r[i];
+        r[i] = x - lo;
+        borrow = (uint64_t) (p >> 64) + (x < lo);
+    }
+    return borrow;
+}
+
+void mpn_mul_basecase(uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b, size_t bn) {
+    // First row initializes r, the others accumulate into it
+    r[an] = mpn_mul_1(r, a, an, b[0]);
+    for (size_t j = 1; j < bn; ++j) {
+        r[an + j] = mpn_addmul_1(r + j, a, an, b[j]);
+    }
+}
+
+uint64_t mpn_invert_limb(uint64_t d) {
+    // (2^128 - 1 - d * 2^64) / d, whose quotient fits in a limb
+    unsigned __int128 num = ((unsigned __int128) ~d << 64) | ~uint64_t(0);
+    return (uint64_t) (num / d);
+}
+
+LimbDivisor mpn_limb_divisor(uint64_t d) {
+    LimbDivisor div;
+    div.shift = __builtin_clzll(d);
+    div.d = d << div.shift;
+    div.dinv = mpn_invert_limb(div.d);
+    return div;
+}
+
+// Divide the two-limb value (u1, u0) by a normalized d with reciprocal
+// dinv, where u1 < d: Algorithm 4 of Möller and Granlund. Stores the
+// remainder in r and returns the quotient.
+static inline uint64_t div_2by1(uint64_t &r, uint64_t u1, uint64_t u0, uint64_t d, uint64_t dinv) {
+    unsigned __int128 q = (unsigned __int128) dinv * u1 + (((unsigned __int128) u1 << 64) | u0);
+    uint64_t q1 = (uint64_t) (q >> 64) + 1;
+    uint64_t q0 = (uint64_t) q;
+    uint64_t rem = u0 - q1 * d;
+    if (rem > q0) {  // the estimate was one too large
+        --q1;
+        rem += d;
+    }
+    if (rem >= d) {  // rarely, one too small
+        ++q1;
+        rem -= d;
+    }
+    r = rem;
+    return q1;
+}
+
+uint64_t mpn_divrem_1_preinv(uint64_t *q, const uint64_t *a, size_t n, const LimbDivisor &div) {
+    if (n == 0) {
+        return 0;
+    }
+
+    // Divide a * 2^shift by the normalized divisor (which has the same
+    // quotient), shifting the dividend limbs on the fly; the bits
+    // shifted out of the top limb start off the remainder
+    unsigned s = div.shift;
+    uint64_t r = s ? a[n - 1] >> (64 - s) : 0;
+    for (size_t i = n; i-- > 0; ) {
+        uint64_t u0 = a[i] << s;
+        if (s && i > 0) {
+            u0 |= a[i - 1] >> (64 - s);
+        }
+        q[i] = div_2by1(r, r, u0, div.d, div.dinv);
+    }
+    return r >> s;
+}
+
+uint64_t mpn_mod_1_preinv(const uint64_t *a, size_t n, const LimbDivisor &div) {
+    if (n == 0) {
+        return 0;
+    }
+
+    unsigned s = div.shift;
+    uint64_t r = s ? a[n - 1] >> (64 - s) : 0;
+    for (size_t i = n; i-- > 0; ) {
+        uint64_t u0 = a[i] << s;
+        if (s && i > 0) {
+            u0 |= a[i - 1] >> (64 - s);
+        }
+        div_2by1(r, r, u0, div.d, div.dinv);
+    }
+    return r >> s;
+}
+
+uint64_t mpn_divrem_1(uint64_t *q, const uint64_t *a, size_t n, uint64_t d) {
+    return mpn_divrem_1_preinv(q, a, n, mpn_limb_divisor(d));
+}
+
+uint64_t mpn_mod_1(const uint64_t *a, size_t n, uint64_t d) {
+    return mpn_mod_1_preinv(a, n, mpn_limb_divisor(d));
+}
+
+void mpn_tdiv_qr(uint64_t *q, uint64_t *r, const uint64_t *a, size_t an,
+                 const uint64_t *d, size_t dn) {
+    if (dn == 1) {
+        r[0] = mpn_divrem_1(q, a, an, d[0]);
+        return;
+    }
+
+    // Normalize: shift so the divisor's top bit is set, which makes the
+    // two-limb quotient estimate below at most 2 too large. The
+    // dividend gets an extra top limb for the bits shifted out.
+    unsigned s = __builtin_clzll(d[dn - 1]);
+    std::vector<uint64_t> v(dn), u(an + 1);
+    if (s) {
+        mpn_lshift(v.data(), d, dn, s);
+        u[an] = mpn_lshift(u.data(), a, an, s);
+    } else {
+        std::copy(d, d + dn, v.begin());
+        std::copy(a, a + an, u.begin());
+        u[an] = 0;
+    }
+
+    const uint64_t d1 = v[dn - 1], d0 = v[dn - 2];
+    const uint64_t d1inv = mpn_invert_limb(d1);
+    for (size_t j = an - dn + 1; j-- > 0; ) {
+        // Estimate the quotient limb from the top two limbs of the
+        // current window u[j .. j + dn] (whose value is below v * 2^64)
+        uint64_t u2 = u[j + dn], u1 = u[j + dn - 1], u0 = u[j + dn - 2];
+        unsigned __int128 qhat, rhat;
+        if (u2 >= d1) {
+            qhat = UINT64_MAX;
+            rhat = (((unsigned __int128) u2 << 64) | u1) - qhat * d1;
+        } else {
+            uint64_t r1;
+            qhat = div_2by1(r1, u2, u1, d1, d1inv);
+            rhat = r1;
+        }
+
+        // Refine with the next limb; this leaves qhat at most 1 too large
+        while ((rhat >> 64) == 0 && qhat * d0 > ((rhat << 64) | u0)) {
+            --qhat;
+            rhat += d1;
+        }
+
+        // Subtract qhat * v from the window, adding v back if it went negative
+        uint64_t borrow = mpn_submul_1(u.data() + j, v.data(), dn, (uint64_t) qhat);
+        uint64_t top = u[j + dn];
+        u[j + dn] = top - borrow;
+        if (top < borrow) {
+            --qhat;
+            u[j + dn] += mpn_add_n(u.data() + j, u.data() + j, v.data(), dn);
+        }
+        q[j] = (uint64_t) qhat;
+    }
+
+    // The remainder is the low dn limbs of u, shifted back down
+    if (s) {
+        mpn_rshift(r, u.data(), dn, s);
+    } else {
+        std::copy(u.begin(), u.begin() + dn, r);
+    }
+}
+
+void mpn_pow2_mod(uint64_t *r, uint64_t k, const uint64_t *m, size_t n) {
+    // Start from 1 mod m (zero only when m = 1), then double; as r < m,
+    // each doubling needs at most one subtraction
+    std::fill(r, r + n, 0);
+    r[0] = 1;
+    if (mpn_cmp(r, m, n) >= 0) {
+        r[0] = 0;
+    }
+    for (uint64_t i = 0; i < k; ++i) {
+        uint64_t top = mpn_lshift(r, r, n, 1);
+        if (top || mpn_cmp(r, m, n) >= 0) {
+            mpn_sub_n(r, r, m, n);
+        }
+    }
+}
+
+uint64_t mpn_lshift(uint64_t *r, const uint64_t *a, size_t n, unsigned cnt) {
+    if (n == 0) {
+        return 0;
+    }
+    uint64_t out = a[n - 1] >> (64 - cnt);
+    for (size_t i = n - 1; i > 0; --i) {
+        r[i] = (a[i] << cnt) | (a[i - 1] >> (64 - cnt));
+    }
+    r[0] = a[0] << cnt;
+    return out;
+}
+
+uint64_t mpn_rshift(uint64_t *r, const uint64_t *a, size_t n, unsigned cnt) {
+    if (n == 0) {
+        return 0;
+    }
+    uint64_t out = a[0] << (64 - cnt);
+    for (size_t i = 0; i + 1 < n; ++i) {
+        r[i] = (a[i] >> cnt) | (a[i + 1] << (64 - cnt));
+    }
+    r[n - 1] = a[n - 1] >> cnt;
+    return out;
+}
+
+int mpn_cmp(const uint64_t *a, const uint64_t *b, size_t n) {
+    for (size_t i = n; i-- > 0; ) {
+        if (a[i] != b[i]) {
+            return a[i] > b[i] ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+size_t mpn_normalized_size(const uint64_t *a, size_t n) {
+    while (n > 0 && a[n - 1] == 0) {
+        --n;
+    }
+    return n;
+}
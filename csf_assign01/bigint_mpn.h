@@ -0,0 +1,174 @@
+#ifndef BIGINT_MPN_H
+#define BIGINT_MPN_H
+
+#include <cstdint>
+#include <cstddef>
+
+//! @file
+//! Low-level arithmetic on raw limb arrays (after GMP's `mpn` layer).
+//!
+//! A natural number of n limbs is an array of n `uint64_t` values,
+//! least significant first. These functions take plain pointers and
+//! sizes, write into caller-provided buffers, and never allocate
+//! (except `mpn_tdiv_qr`, for its normalized working copies). Sizes
+//! are not normalized: leading zero limbs are allowed everywhere
+//! unless stated otherwise.
+//!
+//! Unless stated otherwise, an output may be the same array as an
+//! input (exact aliasing) but must not partially overlap one.
+
+//! Compute r = a + b, where a and b both have n limbs.
+//!
+//! @return the carry out of the top limb (0 or 1)
+uint64_t mpn_add_n(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n);
+
+//! Compute r = a + b, where a has an limbs, b has bn limbs and an >= bn.
+//! r receives an limbs.
+//!
+//! @return the carry out of the top limb (0 or 1)
+uint64_t mpn_add(uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b, size_t bn);
+
+//! Compute r = a + b, where a has n limbs and b is a single limb.
+//!
+//! @return the carry out of the top limb (0 or 1)
+uint64_t mpn_add_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b);
+
+//! Compute r = a - b, where a and b both have n limbs.
+//!
+//! @return the borrow out of the top limb (0 or 1; 1 if a < b)
+uint64_t mpn_sub_n(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n);
+
+//! Compute r = a - b, where a has an limbs, b has bn limbs and an >= bn.
+//! r receives an limbs.
+//!
+//! @return the borrow out of the top limb (0 or 1; 1 if a < b)
+uint64_t mpn_sub(uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b, size_t bn);
+
+//! Compute r = a - b, where a has n limbs and b is a single limb.
+//!
+//! @return the borrow out of the top limb (0 or 1; 1 if a < b)
+uint64_t mpn_sub_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b);
+
+//! Compute r = -a mod 2^(64 n) (two's complement negation), where a
+//! has n limbs.
+//!
+//! @return 1 if a is nonzero (i.e., a borrow out of the top), else 0
+uint64_t mpn_neg(uint64_t *r, const uint64_t *a, size_t n);
+
+//! Compute r = a * b, where a has n limbs and b is a single limb.
+//! r receives the low n limbs of the product.
+//!
+//! @return the high limb of the product
+uint64_t mpn_mul_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b);
+
+//! Compute r += a * b, where r and a have n limbs and b is a single
+//! limb. r must not partially overlap a.
+//!
+//! @return the carry limb out of the top of r
+uint64_t mpn_addmul_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b);
+
+//! Compute r -= a * b, where r and a have n limbs and b is a single
+//! limb. r must not partially overlap a.
+//!
+//! @return the borrow limb out of the top of r
+uint64_t mpn_submul_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b);
+
+//! Schoolbook product r = a * b, where a has an limbs and b has bn
+//! limbs (an, bn >= 1). r receives an + bn limbs and must not overlap
+//! a or b.
+void mpn_mul_basecase(uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b, size_t bn);
+
+//! A single-limb divisor with its precomputed reciprocal, for division
+//! without hardware divide instructions (Möller and Granlund,
+//! "Improved division by invariant integers", 2011).
+struct LimbDivisor {
+  uint64_t d;      //!< the divisor shifted left so its top bit is set
+  uint64_t dinv;   //!< reciprocal of `d`: floor((2^128 - 1) / d) - 2^64
+  unsigned shift;  //!< number of bits `d` was shifted left by
+};
+
+//! Compute the reciprocal of a normalized limb (top bit set).
+//!
+//! @return floor((2^128 - 1) / d) - 2^64
+uint64_t mpn_invert_limb(uint64_t d);
+
+//! Prepare a nonzero single-limb divisor for `mpn_divrem_1_preinv`
+//! and `mpn_mod_1_preinv`. This costs about one division, so reusing
+//! the result pays off when dividing by the same value repeatedly.
+//!
+//! @param d the divisor (must be nonzero)
+//! @return the normalized divisor and its reciprocal
+LimbDivisor mpn_limb_divisor(uint64_t d);
+
+//! Divide a (n limbs) by a prepared single-limb divisor. Each limb
+//! takes two multiplications instead of a division. q receives the n
+//! limbs of the quotient and may alias a.
+//!
+//! @return the remainder
+uint64_t mpn_divrem_1_preinv(uint64_t *q, const uint64_t *a, size_t n, const LimbDivisor &div);
+
+//! @return the remainder of a (n limbs) divided by a prepared divisor
+uint64_t mpn_mod_1_preinv(const uint64_t *a, size_t n, const LimbDivisor &div);
+
+//! Divide a (n limbs) by a single nonzero limb d (using
+//! `mpn_divrem_1_preinv`). q receives the n limbs of the quotient and
+//! may alias a.
+//!
+//! @return the remainder
+uint64_t mpn_divrem_1(uint64_t *q, const uint64_t *a, size_t n, uint64_t d);
+
+//! @return the remainder of a (n limbs) divided by a single nonzero limb d
+uint64_t mpn_mod_1(const uint64_t *a, size_t n, uint64_t d);
+
+//! Divide a (an limbs) by d (dn limbs), where an >= dn >= 1 and the
+//! top limb of d is nonzero. q receives an - dn + 1 quotient limbs and
+//! r receives dn remainder limbs; neither may overlap the inputs or
+//! each other. Uses Knuth's Algorithm D (TAOCP vol. 2, 4.3.1).
+void mpn_tdiv_qr(uint64_t *q, uint64_t *r, const uint64_t *a, size_t an,
+                 const uint64_t *d, size_t dn);
+
+//! Compute the Montgomery reduction constant for a modulus whose low
+//! limb is d, by Newton iteration (each step doubles the number of
+//! correct low bits, from the 3 that d * d = 1 mod 8 gives). It is
+//! constexpr so that compile-time moduli can use it too.
+//!
+//! @param d an odd limb
+//! @return -d^(-1) mod 2^64
+constexpr uint64_t mpn_neg_inverse_limb(uint64_t d) {
+  uint64_t inv = d;
+  for (int k = 0; k < 5; ++k) {
+    inv *= 2 - d * inv;
+  }
+  return 0 - inv;
+}
+
+//! Compute r = 2^k mod m, where m has n limbs and is nonzero (its top
+//! limbs may be zero). r receives n limbs and must not overlap m. This
+//! takes k modular doublings, so it is meant for setting up constants
+//! such as the Montgomery R mod N and R^2 mod N.
+void mpn_pow2_mod(uint64_t *r, uint64_t k, const uint64_t *m, size_t n);
+
+//! Compute r = a << cnt, where a has n limbs and 0 < cnt < 64. r
+//! receives n limbs. The limbs are processed from the top down, so r
+//! may also overlap a at a higher address.
+//!
+//! @return the bits shifted out of the top, in the low cnt bits
+uint64_t mpn_lshift(uint64_t *r, const uint64_t *a, size_t n, unsigned cnt);
+
+//! Compute r = a >> cnt, where a has n limbs and 0 < cnt < 64. r
+//! receives n limbs. The limbs are processed from the bottom up, so r
+//! may also overlap a at a lower address.
+//!
+//! @return the bits shifted out of the bottom, in the high cnt bits
+uint64_t mpn_rshift(uint64_t *r, const uint64_t *a, size_t n, unsigned cnt);
+
+//! Compare a and b, both of n limbs.
+//!
+//! @return negative, 0 or positive as a is less than, equal to or
+//!         greater than b
+int mpn_cmp(const uint64_t *a, const uint64_t *b, size_t n);
+
+//! @return n less the number of leading zero limbs of a
+size_t mpn_normalized_size(const uint64_t *a, size_t n);
+
+#endif // BIGINT_MPN_H
@@ -0,0 +1,123 @@
+#include "bigint_rational.h"
+#include "bigint_math.h"
+#include <cmath>
+#include <stdexcept>
+
+BigRational::BigRational() : den(1), canonical(true) {}
+
+BigRational::BigRational(const BigInt &val) : num(val), den(1), canonical(true) {}
+
+BigRational::BigRational(const BigInt &num, const BigInt &den)
+    : BigRational(num, den, false) {}
+
+// Moves the sign to the numerator; zero (0/1) and integers (n/1) are
+// always canonical
+BigRational::BigRational(const BigInt &num, const BigInt &den, bool canonical)
+    : num(num), den(den), canonical(canonical) {
+
+    if (den.is_zero()) {
+        throw std::invalid_argument("Zero denominator");
+    }
+    if (den.is_negative()) {
+        this->num = -num;
+        this->den = -den;
+    }
+    if (num.is_zero()) {
+        this->den = BigInt(1);
+        this->canonical = true;
+    } else if (this->den == 1) {
+        this->canonical = true;
+    }
+}
+
+BigRational &BigRational::canonicalize() {
+    if (!canonical) {
+        BigInt g = gcd(num, den);
+        if (g != 1) {
+            num = num / g;
+            den = den / g;
+        }
+        canonical = true;
+    }
+    return *this;
+}
+
+BigRational BigRational::operator+(const BigRational &rhs) const {
+    if (!canonical || !rhs.canonical) {
+        return BigRational(num * rhs.den + rhs.num * den, den * rhs.den, false);
+    }
+
+    // a/b + c/d with both in lowest terms: with g = gcd(b, d), any
+    // common factor of the sum's numerator t and denominator divides g
+    BigInt g = gcd(den, rhs.den);
+    if (g == 1) {
+        return BigRational(num * rhs.den + rhs.num * den, den * rhs.den, true);
+    }
+    BigInt b = den / g;
+    BigInt t = num * (rhs.den / g) + rhs.num * b;
+    BigInt g2 = gcd(t, g);
+    if (g2 == 1) {
+        return BigRational(t, b * rhs.den, true);
+    }
+    return BigRational(t / g2, b * (rhs.den / g2), true);
+}
+
+BigRational BigRational::operator-(const BigRational &rhs) const {
+    return *this + -rhs;
+}
+
+BigRational BigRational::operator*(const BigRational &rhs) const {
+    if (!canonical || !rhs.canonical) {
+        return BigRational(num * rhs.num, den * rhs.den, false);
+    }
+
+    // (a/b)(c/d) with both in lowest terms: only a and d, or c and b,
+    // can share factors
+    BigInt g1 = gcd(num, rhs.den), g2 = gcd(rhs.num, den);
+    return BigRational((num / g1) * (rhs.num / g2), (den / g2) * (rhs.den / g1), true);
+}
+
+BigRational BigRational::operator/(const BigRational &rhs) const {
+    if (rhs.is_zero()) {
+        throw std::invalid_argument("Division by zero");
+    }
+    // The reciprocal is in lowest terms exactly when rhs is
+    return *this * BigRational(rhs.den, rhs.num, rhs.canonical);
+}
+
+BigRational BigRational::operator-() const {
+    return BigRational(-num, den, canonical);
+}
+
+int BigRational::compare(const BigRational &rhs) const {
+    // The denominators are positive, so the signs decide first, and
+    // otherwise a/b < c/d exactly when a * d < c * b
+    if (num.is_negative() != rhs.num.is_negative()) {
+        return num.is_negative() ? -1 : 1;
+    }
+    if (den == rhs.den) {
+        return num.compare(rhs.num);
+    }
+    return (num * rhs.den).compare(rhs.num * den);
+}
+
+double BigRational::to_double() const {
+    if (is_zero()) {
+        return 0.0;
+    }
+    // Scale by 2^k so the integer quotient has at least 64 bits
+    BigInt mag = num.is_negative() ? -num : num;
+    long k = static_cast<long>(den.bit_length()) - static_cast<long>(mag.bit_length()) + 65;
+    BigInt q = (k >= 0) ? (mag << k) / den : mag / (den << -k);
+    double result = std::ldexp(q.to_double(), static_cast<int>(-k));
+    return num.is_negative() ? -result : result;
+}
+
+std::string BigRational::to_dec() const {
+    BigRational reduced = *this;
+    reduced.canonicalize();
+    if (reduced.den == 1) {
+        return reduced.num.to_dec();
+    }
+    return reduced.num.to_dec() + "/" + reduced.den.to_dec();
+}
@@ -0,0 +1,112 @@
+#ifndef BIGINT_RATIONAL_H
+#define BIGINT_RATIONAL_H
+
+#include <string>
+#include "bigint.h"
+
+//! @file
+//! Exact rational numbers with BigInt numerator and denominator.
+
+//! Class representing an exact rational number num/den, with den > 0.
+//!
+//! Reduction to lowest terms is lazy. A value built from an arbitrary
+//! numerator and denominator is kept as given (with the sign moved to
+//! the numerator) until `canonicalize()` is called, and arithmetic on
+//! such values just cross-multiplies without computing any GCD.
+//! When both operands are already canonical, the result is made
+//! canonical with the cheaper method of Knuth (TAOCP vol. 2, 4.5.1).
+//! That method takes GCDs of the (smaller) input numerators and
+//! denominators instead of one large GCD of the result. Comparison
+//! never needs a GCD.
+class BigRational {
+private:
+   BigInt num;
+   BigInt den;       // always positive
+   bool canonical;   // known to be in lowest terms
+
+   BigRational(const BigInt &num, const BigInt &den, bool canonical);
+
+public:
+  //! Default constructor: the value 0.
+  BigRational();
+
+  //! Constructor from an integer (which is already canonical).
+  //!
+  //! @param val the integer value
+  BigRational(const BigInt &val);
+
+  //! Constructor from a numerator and denominator, which are not
+  //! reduced (see `canonicalize`).
+  //!
+  //! @param num the numerator
+  //! @param den the denominator
+  //! @throw std::invalid_argument if `den` is zero
+  BigRational(const BigInt &num, const BigInt &den);
+
+  //! @return the numerator as stored (carrying the sign; it may share
+  //!         a factor with the denominator unless `is_canonical()`)
+  const BigInt &numerator() const { return num; }
+
+  //! @return the denominator as stored (always positive)
+  const BigInt &denominator() const { return den; }
+
+  //! @return true if the value is known to be in lowest terms
+  bool is_canonical() const { return canonical; }
+
+  //! Reduce to lowest terms (one GCD), unless already canonical.
+  //!
+  //! @return a reference to this value
+  BigRational &canonicalize();
+
+  //! @return true if the value is zero
+  bool is_zero() const { return num.is_zero(); }
+
+  //! @return true if the value is negative
+  bool is_negative() const { return num.is_negative(); }
+
+  //! @param rhs the right-hand side value
+  //! @return the sum
+  BigRational operator+(const BigRational &rhs) const;
+
+  //! @param rhs the right-hand side value
+  //! @return the difference
+  BigRational operator-(const BigRational &rhs) const;
+
+  //! @param rhs the right-hand side value
+  //! @return the product
+  BigRational operator*(const BigRational &rhs) const;
+
+  //! @param rhs the right-hand side value
+  //! @return the quotient
+  //! @throw std::invalid_argument if `rhs` is zero
+  BigRational operator/(const BigRational &rhs) const;
+
+  //! @return the negated value
+  BigRational operator-() const;
+
+  //! Compare by cross-multiplication (no reduction needed).
+  //!
+  //! @param rhs the right-hand side value
+  //! @return negative, 0 or positive as this value is less than,
+  //!         equal to or greater than `rhs`
+  int compare(const BigRational &rhs) const;
+
+  bool operator==(const BigRational &rhs) const { return compare(rhs) == 0; }
+  bool operator!=(const BigRational &rhs) const { return compare(rhs) != 0; }
+  bool operator<(const BigRational &rhs) const  { return compare(rhs) < 0; }
+  bool operator<=(const BigRational &rhs) const { return compare(rhs) <= 0; }
+  bool operator>(const BigRational &rhs) const  { return compare(rhs) > 0; }
+  bool operator>=(const BigRational &rhs) const { return compare(rhs) >= 0; }
+
+  //! Convert to `double`, from a quotient with at least 64 significant
+  //! bits (so the result is within one unit in the last place).
+  //!
+  //! @return the value as a `double`
+  double to_double() const;
+
+  //! @return the value in lowest terms in decimal, as "num/den", or
+  //!         just "num" if the denominator is 1
+  std::string to_dec() const;
+};
+
+#endif // BIGINT_RATIONAL_H
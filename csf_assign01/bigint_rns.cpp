@@ -0,0 +1,301 @@
+#include "bigint_rns.h"
+#include "bigint_math.h"
+#include <algorithm>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+
+// Primes below 2^62, largest first, shared by every basis (so a basis
+// of k primes is always the first k of them)
+static std::mutex prime_mutex;
+static std::vector<uint64_t> prime_cache;
+
+static uint64_t mulmod(uint64_t a, uint64_t b, uint64_t m) {
+    return static_cast<uint64_t>((unsigned __int128) a * b % m);
+}
+
+// Miller-Rabin with the first 12 primes as bases, which is
+// deterministic for every 64-bit n
+static bool is_prime_u64(uint64_t n) {
+    static const uint64_t bases[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+    for (uint64_t p : bases) {
+        if (n % p == 0) {
+            return n == p;
+        }
+    }
+    uint64_t d = n - 1;
+    int s = 0;
+    while ((d & 1) == 0) {
+        d >>= 1;
+        ++s;
+    }
+    for (uint64_t a : bases) {
+        uint64_t x = 1, base = a;
+        for (uint64_t e = d; e; e >>= 1) {
+            if (e & 1) {
+                x = mulmod(x, base, n);
+            }
+            base = mulmod(base, base, n);
+        }
+        bool witness = (x != 1 && x != n - 1);
+        for (int r = 1; r < s && witness; ++r) {
+            x = mulmod(x, x, n);
+            witness = (x != n - 1);
+        }
+        if (witness) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::vector<uint64_t> rns_primes(size_t k) {
+    std::lock_guard<std::mutex> lock(prime_mutex);
+    uint64_t c = prime_cache.empty() ? (1ULL << 62) - 1 : prime_cache.back() - 2;
+    for (; prime_cache.size() < k; c -= 2) {
+        if (is_prime_u64(c)) {
+            prime_cache.push_back(c);
+        }
+    }
+    return std::vector<uint64_t>(prime_cache.begin(), prime_cache.begin() + k);
+}
+
+// a * b / 2^64 mod p, for a, b < p < 2^62 (so nothing overflows and
+// the unreduced result is below 2p)
+static inline uint64_t mont_mul(uint64_t a, uint64_t b, uint64_t p, uint64_t ninv) {
+    unsigned __int128 t = (unsigned __int128) a * b;
+    uint64_t q = static_cast<uint64_t>(t) * ninv;
+    uint64_t u = static_cast<uint64_t>((t + (unsigned __int128) q * p) >> 64);
+    return u - (p & (0 - static_cast<uint64_t>(u >= p)));
+}
+
+RNSBasis::RNSBasis(size_t bits) : bits(bits) {
+    // Every prime is above 2^61, so k primes give M > 2^(61 k)
+    size_t k = std::max<size_t>(1, (bits + 2 + 60) / 61);
+    primes = rns_primes(k);
+    ninv.resize(k);
+    r2.resize(k);
+    divisors.resize(k);
+
+    for (size_t i = 0; i < k; ++i) {
+        uint64_t p = primes[i];
+        ninv[i] = mpn_neg_inverse_limb(p);
+        uint64_t r_mod = (0 - p) % p;
+        r2[i] = mulmod(r_mod, r_mod, p);
+        divisors[i] = mpn_limb_divisor(p);
+    }
+
+    std::vector<BigInt> factors(primes.begin(), primes.end());
+    mod_value = product(factors);
+    half_mod = mod_value >> 1;
+}
+
+void RNSBasis::compute_garner() const {
+    size_t k = primes.size();
+    garner.resize(k);
+    for (size_t i = 0; i < k; ++i) {
+        uint64_t p = primes[i], pinv = ninv[i];
+        uint64_t one = mont_mul(1, r2[i], p, pinv);
+
+        // prod^(p_i - 2), for prod = p_0 ... p_(i-1) mod p_i (each of
+        // which is below 2 p_i)
+        uint64_t prod = one;
+        for (size_t j = 0; j < i; ++j) {
+            prod = mont_mul(prod, mont_mul(primes[j] - p, r2[i], p, pinv), p, pinv);
+        }
+        uint64_t c = one;
+        for (uint64_t e = p - 2; e; e >>= 1) {
+            if (e & 1) {
+                c = mont_mul(c, prod, p, pinv);
+            }
+            prod = mont_mul(prod, prod, p, pinv);
+        }
+        garner[i] = c;
+    }
+}
+
+void RNSBasis::to_residues(uint64_t *res, const BigIntView &val) const {
+    for (size_t i = 0; i < primes.size(); ++i) {
+        uint64_t p = primes[i];
+        uint64_t r = val.size() ? mpn_mod_1_preinv(val.data(), val.size(), divisors[i]) : 0;
+        r = mont_mul(r, r2[i], p, ninv[i]);
+        res[i] = (val.is_negative() && r) ? p - r : r;
+    }
+}
+
+uint64_t RNSBasis::residue(const uint64_t *res, size_t i) const {
+    return mont_mul(res[i], 1, primes[i], ninv[i]);
+}
+
+BigInt RNSBasis::from_residues(const uint64_t *res) const {
+    size_t k = primes.size();
+    std::call_once(garner_once, &RNSBasis::compute_garner, this);
+
+    // Garner: x = v_0 + p_0 (v_1 + p_1 (v_2 + ...)) with each v_i < p_i,
+    // where v_i = (x - (v_0 + ... + v_(i-1) p_0 ... p_(i-2))) / (p_0 ... p_(i-1))
+    // mod p_i. The earlier primes are larger but below 2 p_i, so they
+    // (and the digits) reduce mod p_i with one subtraction.
+    std::vector<uint64_t> v(k);
+    for (size_t i = 0; i < k; ++i) {
+        uint64_t p = primes[i], pinv = ninv[i];
+        uint64_t r = residue(res, i);
+        uint64_t s = 0;
+        for (size_t j = i; j-- > 0; ) {
+            s = mont_mul(s, mont_mul(primes[j] - p, r2[i], p, pinv), p, pinv);
+            uint64_t vj = (v[j] >= p) ? v[j] - p : v[j];
+            s += vj;
+            s -= p & (0 - static_cast<uint64_t>(s >= p));
+        }
+        uint64_t d = (r >= s) ? r - s : r + p - s;
+        v[i] = mont_mul(d, garner[i], p, pinv);
+    }
+
+    // Evaluate the mixed-radix digits from the top
+    std::vector<uint64_t> x(k + 1, 0);
+    size_t n = 1;
+    x[0] = v[k - 1];
+    for (size_t j = k - 1; j-- > 0; ) {
+        uint64_t carry = mpn_mul_1(x.data(), x.data(), n, primes[j]);
+        if (carry) {
+            x[n++] = carry;
+        }
+        carry = mpn_add_1(x.data(), x.data(), n, v[j]);
+        if (carry) {
+            x[n++] = carry;
+        }
+    }
+    BigInt result = BigIntView(x.data(), mpn_normalized_size(x.data(), n)).to_bigint();
+    return (result > half_mod) ? result - mod_value : result;
+}
+
+// The lane loops are branch-free, and no lane depends on another, so
+// add and sub compile to vector loops (this file is built with -O3; the
+// 64-bit compares need SSE4.2 or AVX2, which SIMD_FLAGS in the Makefile
+// can enable). mul stays scalar, as x86 vector units have no
+// 64x64 -> 128-bit multiply.
+
+void RNSBasis::add(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t begin, size_t end) const {
+    const uint64_t *p = primes.data();
+    for (size_t i = begin; i < end; ++i) {
+        uint64_t s = a[i] + b[i];
+        r[i] = s - (p[i] & (0 - static_cast<uint64_t>(s >= p[i])));
+    }
+}
+
+void RNSBasis::sub(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t begin, size_t end) const {
+    const uint64_t *p = primes.data();
+    for (size_t i = begin; i < end; ++i) {
+        uint64_t d = a[i] - b[i];
+        r[i] = d + (p[i] & (0 - static_cast<uint64_t>(a[i] < b[i])));
+    }
+}
+
+void RNSBasis::mul(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t begin, size_t end) const {
+    const uint64_t *p = primes.data(), *pinv = ninv.data();
+    for (size_t i = begin; i < end; ++i) {
+        r[i] = mont_mul(a[i], b[i], p[i], pinv[i]);
+    }
+}
+
+RNSInt::RNSInt(const std::shared_ptr<const RNSBasis> &ctx)
+    : ctx(ctx), res(ctx->size(), 0) {}
+
+RNSInt::RNSInt(const std::shared_ptr<const RNSBasis> &ctx, const BigIntView &val)
+    : ctx(ctx) {
+    if (!ctx) {
+        throw std::invalid_argument("RNSInt needs a basis");
+    }
+    res.resize(ctx->size());
+    ctx->to_residues(res.data(), val);
+}
+
+std::shared_ptr<const RNSBasis> RNSInt::context(size_t bits) {
+    return std::make_shared<const RNSBasis>(bits);
+}
+
+// Bases with the same number of primes have the same primes
+void RNSInt::check_same(const RNSInt &rhs) const {
+    if (ctx != rhs.ctx && ctx->size() != rhs.ctx->size()) {
+        throw std::invalid_argument("RNSInt operands have different bases");
+    }
+}
+
+void RNSInt::apply(LaneOp op, uint64_t *r, const uint64_t *a, const uint64_t *b) const {
+    const RNSBasis *basis = ctx.get();
+    size_t k = basis->size();
+    size_t threads = std::min<size_t>(BigInt::get_max_threads(), k / PARALLEL_THRESHOLD);
+    if (threads <= 1) {
+        (basis->*op)(r, a, b, 0, k);
+        return;
+    }
+
+    size_t chunk = (k + threads - 1) / threads;
+    std::vector<std::future<void>> tasks;
+    for (size_t t = 1; t < threads; ++t) {
+        size_t begin = t * chunk, end = std::min(k, begin + chunk);
+        tasks.push_back(std::async(std::launch::async,
+                                   [=]() { (basis->*op)(r, a, b, begin, end); }));
+    }
+    (basis->*op)(r, a, b, 0, chunk);
+    for (std::future<void> &task : tasks) {
+        task.get();
+    }
+}
+
+BigInt RNSInt::to_bigint() const {
+    return ctx->from_residues(res.data());
+}
+
+bool RNSInt::is_zero() const {
+    return std::all_of(res.begin(), res.end(), [](uint64_t x) { return x == 0; });
+}
+
+RNSInt &RNSInt::operator+=(const RNSInt &rhs) {
+    check_same(rhs);
+    apply(&RNSBasis::add, res.data(), res.data(), rhs.res.data());
+    return *this;
+}
+
+RNSInt &RNSInt::operator-=(const RNSInt &rhs) {
+    check_same(rhs);
+    apply(&RNSBasis::sub, res.data(), res.data(), rhs.res.data());
+    return *this;
+}
+
+RNSInt &RNSInt::operator*=(const RNSInt &rhs) {
+    check_same(rhs);
+    apply(&RNSBasis::mul, res.data(), res.data(), rhs.res.data());
+    return *this;
+}
+
+RNSInt RNSInt::operator+(const RNSInt &rhs) const {
+    check_same(rhs);
+    RNSInt result(ctx);
+    apply(&RNSBasis::add, result.res.data(), res.data(), rhs.res.data());
+    return result;
+}
+
+RNSInt RNSInt::operator-(const RNSInt &rhs) const {
+    check_same(rhs);
+    RNSInt result(ctx);
+    apply(&RNSBasis::sub, result.res.data(), res.data(), rhs.res.data());
+    return result;
+}
+
+RNSInt RNSInt::operator*(const RNSInt &rhs) const {
+    check_same(rhs);
+    RNSInt result(ctx);
+    apply(&RNSBasis::mul, result.res.data(), res.data(), rhs.res.data());
+    return result;
+}
+
+RNSInt RNSInt::operator-() const {
+    RNSInt result(ctx);
+    apply(&RNSBasis::sub, result.res.data(), result.res.data(), res.data());
+    return result;
+}
+
+bool RNSInt::operator==(const RNSInt &rhs) const {
+    check_same(rhs);
+    return res == rhs.res;
+}
@@ -0,0 +1,161 @@
+#ifndef BIGINT_RNS_H
+#define BIGINT_RNS_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+#include "bigint.h"
+#include "bigint_mpn.h"
+
+//! @file
+//! Residue number system: integers as their residues modulo a set of
+//! word-sized primes.
+
+//! Class holding a residue number system basis: the k largest primes
+//! below 2^62 (all above 2^61), with M their product, and the
+//! per-prime constants used for Montgomery arithmetic (R = 2^64),
+//! for reducing BigInts, and for Garner's CRT reconstruction. A basis
+//! is immutable after construction (apart from those last constants,
+//! which are computed once under a lock), so it can be shared between
+//! threads.
+class RNSBasis {
+private:
+   std::vector<uint64_t> primes;
+   std::vector<uint64_t> ninv;     // -p^(-1) mod 2^64
+   std::vector<uint64_t> r2;       // R^2 mod p
+   std::vector<LimbDivisor> divisors;
+
+   // (p_0 ... p_(i-1))^(-1) mod p_i in Montgomery form, computed (in
+   // O(k^2)) on the first conversion back to positional form
+   mutable std::once_flag garner_once;
+   mutable std::vector<uint64_t> garner;
+   void compute_garner() const;
+
+   BigInt mod_value;
+   BigInt half_mod;                // floor(M / 2)
+   size_t bits;
+
+public:
+  //! Constructor.
+  //!
+  //! @param bits the basis represents every integer x with |x| < 2^bits
+  //!        (it has the fewest primes for which M > 2^(bits + 1))
+  explicit RNSBasis(size_t bits);
+
+  //! @return the number of primes
+  size_t size() const { return primes.size(); }
+
+  //! @return the largest magnitude, in bits, that is represented exactly
+  size_t capacity_bits() const { return bits; }
+
+  //! @param i the index of a prime (less than `size()`)
+  //! @return the prime p_i
+  uint64_t prime(size_t i) const { return primes[i]; }
+
+  //! @return the product M of the primes
+  const BigInt &modulus() const { return mod_value; }
+
+  //! Convert residues (in Montgomery form, `size()` of them) to the
+  //! integer they represent, in (-M/2, M/2], by Garner's algorithm.
+  BigInt from_residues(const uint64_t *res) const;
+
+  //! Compute the residues (in Montgomery form) of a value of any size
+  //! or sign. Values beyond the capacity are reduced modulo M.
+  void to_residues(uint64_t *res, const BigIntView &val) const;
+
+  //! Residue-wise arithmetic over lanes [begin, end), which may alias.
+  void add(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t begin, size_t end) const;
+  void sub(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t begin, size_t end) const;
+  void mul(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t begin, size_t end) const;
+
+  //! @return the residue of lane `i`, out of Montgomery form
+  uint64_t residue(const uint64_t *res, size_t i) const;
+};
+
+//! Class representing an integer in a residue number system: one
+//! residue per prime of a shared `RNSBasis`. Addition, subtraction and
+//! multiplication work on each residue independently, with no carries
+//! between them, so long chains of them cost O(k) word operations
+//! each. Positional form is only rebuilt (by CRT) in `to_bigint()`.
+//!
+//! All arithmetic is modulo M: results are exact as long as every
+//! intermediate value stays within the basis capacity. The residue
+//! loops are split across threads (up to `BigInt::get_max_threads()`)
+//! once a basis has `PARALLEL_THRESHOLD` primes.
+class RNSInt {
+private:
+   std::shared_ptr<const RNSBasis> ctx;
+   std::vector<uint64_t> res;   // Montgomery form, ctx->size() residues
+
+   // Zero, with the given basis
+   explicit RNSInt(const std::shared_ptr<const RNSBasis> &ctx);
+
+   void check_same(const RNSInt &rhs) const;
+
+   // r = op(a, b) over every lane, in parallel for large bases
+   typedef void (RNSBasis::*LaneOp)(uint64_t *, const uint64_t *, const uint64_t *,
+                                    size_t, size_t) const;
+   void apply(LaneOp op, uint64_t *r, const uint64_t *a, const uint64_t *b) const;
+
+public:
+  //! Number of primes from which the residue loops use several threads.
+  static const size_t PARALLEL_THRESHOLD = 8192;
+
+  //! Constructor: the residues of `val`.
+  //!
+  //! @param ctx the basis (must not be null)
+  //! @param val the value (reduced modulo M if beyond the capacity)
+  //! @throw std::invalid_argument if `ctx` is null
+  RNSInt(const std::shared_ptr<const RNSBasis> &ctx, const BigIntView &val);
+
+  //! Create a basis for use with this class.
+  //!
+  //! @param bits the capacity in bits (see `RNSBasis`)
+  //! @return the shared basis
+  static std::shared_ptr<const RNSBasis> context(size_t bits);
+
+  //! @return the basis of this value
+  const std::shared_ptr<const RNSBasis> &get_context() const { return ctx; }
+
+  //! @return the value in positional form, in (-M/2, M/2]
+  BigInt to_bigint() const;
+
+  //! @param i the index of a prime
+  //! @return the residue modulo `get_context()->prime(i)`
+  uint64_t residue(size_t i) const { return ctx->residue(res.data(), i); }
+
+  //! @return true if the value is zero (modulo M)
+  bool is_zero() const;
+
+  //! Residue-wise arithmetic.
+  //!
+  //! @param rhs the right-hand side value
+  //! @return the result
+  //! @throw std::invalid_argument if `rhs` has a different basis
+  RNSInt operator+(const RNSInt &rhs) const;
+  RNSInt operator-(const RNSInt &rhs) const;
+  RNSInt operator*(const RNSInt &rhs) const;
+
+  //! In-place residue-wise arithmetic, which allocates nothing unless
+  //! the basis is large enough for the loops to use threads.
+  //!
+  //! @param rhs the right-hand side value
+  //! @return a reference to this value
+  //! @throw std::invalid_argument if `rhs` has a different basis
+  RNSInt &operator+=(const RNSInt &rhs);
+  RNSInt &operator-=(const RNSInt &rhs);
+  RNSInt &operator*=(const RNSInt &rhs);
+
+  //! @return the negated value
+  RNSInt operator-() const;
+
+  //! Equality modulo M (no conversion needed).
+  //!
+  //! @throw std::invalid_argument if `rhs` has a different basis
+  bool operator==(const RNSInt &rhs) const;
+  bool operator!=(const RNSInt &rhs) const { return !(*this == rhs); }
+};
+
+#endif // BIGINT_RNS_H
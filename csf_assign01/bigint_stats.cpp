@@ -0,0 +1,234 @@
+#include "bigint_stats.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+
+static const size_t OP_COUNT = static_cast<size_t>(BigIntOp::COUNT);
+
+static const char *const OP_NAMES[OP_COUNT] = {
+    "add", "sub", "neg", "mul", "div",
+    "lshift", "compare", "to_hex", "to_dec", "copy",
+};
+
+bool bigint_stats_enabled() {
+#ifdef BIGINT_INSTRUMENT
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char *bigint_op_name(BigIntOp op) {
+    size_t i = static_cast<size_t>(op);
+    return i < OP_COUNT ? OP_NAMES[i] : "?";
+}
+
+#ifdef BIGINT_INSTRUMENT
+
+// Counters owned by one thread. Only the owning thread writes them, so
+// relaxed loads and stores suffice; other threads only read them
+// while aggregating. A reset doesn't write them either: it records
+// their current values as a baseline (under the registry lock) that
+// later reads subtract.
+struct ThreadStats {
+    std::atomic<uint64_t> calls[OP_COUNT];
+    std::atomic<uint64_t> limbs[OP_COUNT];
+    std::atomic<uint64_t> allocations[OP_COUNT];
+    std::atomic<uint64_t> bytes[OP_COUNT];
+    std::atomic<uint64_t> nanoseconds[OP_COUNT];
+    unsigned depth[OP_COUNT];  // nesting depth of each operation on this thread
+    BigIntOpStats baseline[OP_COUNT];
+
+    // The counters for op i since the last reset (registry lock held)
+    BigIntOpStats since_reset(size_t i) const;
+
+    ThreadStats();
+    ~ThreadStats();
+};
+
+// All live ThreadStats, plus the totals of threads that have exited.
+// Intentionally never destroyed, so threads (including the main
+// thread) can still retire their counters during program exit.
+struct StatsRegistry {
+    std::mutex lock;
+    std::vector<ThreadStats *> threads;
+    BigIntOpStats retired[OP_COUNT];
+};
+
+static StatsRegistry &registry() {
+    static StatsRegistry *reg = new StatsRegistry();
+    return *reg;
+}
+
+static void bump(std::atomic<uint64_t> &counter, uint64_t n) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+ThreadStats::ThreadStats() {
+    for (size_t i = 0; i < OP_COUNT; ++i) {
+        calls[i] = limbs[i] = allocations[i] = bytes[i] = nanoseconds[i] = 0;
+        depth[i] = 0;
+        baseline[i] = BigIntOpStats();
+    }
+    StatsRegistry &reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    reg.threads.push_back(this);
+}
+
+ThreadStats::~ThreadStats() {
+    StatsRegistry &reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    for (size_t i = 0; i < OP_COUNT; ++i) {
+        BigIntOpStats st = since_reset(i);
+        reg.retired[i].calls += st.calls;
+        reg.retired[i].limbs += st.limbs;
+        reg.retired[i].allocations += st.allocations;
+        reg.retired[i].bytes_allocated += st.bytes_allocated;
+        reg.retired[i].nanoseconds += st.nanoseconds;
+    }
+    reg.threads.erase(std::find(reg.threads.begin(), reg.threads.end(), this));
+}
+
+BigIntOpStats ThreadStats::since_reset(size_t i) const {
+    BigIntOpStats st;
+    st.calls = calls[i].load(std::memory_order_relaxed) - baseline[i].calls;
+    st.limbs = limbs[i].load(std::memory_order_relaxed) - baseline[i].limbs;
+    st.allocations = allocations[i].load(std::memory_order_relaxed) - baseline[i].allocations;
+    st.bytes_allocated = bytes[i].load(std::memory_order_relaxed) - baseline[i].bytes_allocated;
+    st.nanoseconds = nanoseconds[i].load(std::memory_order_relaxed) - baseline[i].nanoseconds;
+    return st;
+}
+
+static ThreadStats &thread_stats() {
+    thread_local ThreadStats stats;
+    return stats;
+}
+
+void bigint_stats_note_alloc(size_t bytes) {
+    ThreadStats &ts = thread_stats();
+    for (size_t i = 0; i < OP_COUNT; ++i) {
+        if (ts.depth[i] > 0) {
+            bump(ts.allocations[i], 1);
+            bump(ts.bytes[i], bytes);
+        }
+    }
+}
+
+BigIntOpScope::BigIntOpScope(BigIntOp op, size_t limbs)
+    : op(op), start(std::chrono::steady_clock::now()) {
+    ThreadStats &ts = thread_stats();
+    size_t i = static_cast<size_t>(op);
+    bump(ts.calls[i], 1);
+    bump(ts.limbs[i], limbs);
+    ++ts.depth[i];
+}
+
+BigIntOpScope::~BigIntOpScope() {
+    ThreadStats &ts = thread_stats();
+    size_t i = static_cast<size_t>(op);
+    // Only the outermost call of a recursive operation adds its time
+    if (--ts.depth[i] == 0) {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        bump(ts.nanoseconds[i], std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+}
+
+BigIntOpStats bigint_stats_get(BigIntOp op) {
+    size_t i = static_cast<size_t>(op);
+    StatsRegistry &reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+
+    BigIntOpStats total = reg.retired[i];
+    for (ThreadStats *ts : reg.threads) {
+        BigIntOpStats st = ts->since_reset(i);
+        total.calls += st.calls;
+        total.limbs += st.limbs;
+        total.allocations += st.allocations;
+        total.bytes_allocated += st.bytes_allocated;
+        total.nanoseconds += st.nanoseconds;
+    }
+    return total;
+}
+
+void bigint_stats_reset() {
+    StatsRegistry &reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    for (size_t i = 0; i < OP_COUNT; ++i) {
+        reg.retired[i] = BigIntOpStats();
+        for (ThreadStats *ts : reg.threads) {
+            BigIntOpStats &base = ts->baseline[i];
+            base.calls = ts->calls[i].load(std::memory_order_relaxed);
+            base.limbs = ts->limbs[i].load(std::memory_order_relaxed);
+            base.allocations = ts->allocations[i].load(std::memory_order_relaxed);
+            base.bytes_allocated = ts->bytes[i].load(std::memory_order_relaxed);
+            base.nanoseconds = ts->nanoseconds[i].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+// Report at exit when BIGINT_STATS is set
+static void dump_at_exit() {
+    bigint_stats_dump(std::cerr);
+}
+
+static bool register_exit_report() {
+    const char *env = std::getenv("BIGINT_STATS");
+    if (env && *env && std::strcmp(env, "0") != 0) {
+        std::atexit(dump_at_exit);
+        return true;
+    }
+    return false;
+}
+
+static bool exit_report_registered = register_exit_report();
+
+#else
+
+BigIntOpStats bigint_stats_get(BigIntOp) {
+    return BigIntOpStats();
+}
+
+void bigint_stats_reset() {}
+
+#endif // BIGINT_INSTRUMENT
+
+void bigint_stats_dump(std::ostream &os) {
+    if (!bigint_stats_enabled()) {
+        os << "BigInt instrumentation is not compiled in (build with INSTRUMENT=1)\n";
+        return;
+    }
+
+    // Leave the caller's formatting as it was
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+
+    os << std::left << std::setw(12) << "op"
+       << std::right << std::setw(12) << "calls"
+       << std::setw(14) << "limbs"
+       << std::setw(12) << "allocs"
+       << std::setw(14) << "bytes"
+       << std::setw(12) << "ms"
+       << std::setw(14) << "allocs/call" << "\n";
+
+    for (size_t i = 0; i < OP_COUNT; ++i) {
+        BigIntOpStats st = bigint_stats_get(static_cast<BigIntOp>(i));
+        if (st.calls == 0) {
+            continue;
+        }
+        os << std::left << std::setw(12) << OP_NAMES[i]
+           << std::right << std::setw(12) << st.calls
+           << std::setw(14) << st.limbs
+           << std::setw(12) << st.allocations
+           << std::setw(14) << st.bytes_allocated
+           << std::setw(12) << std::fixed << std::setprecision(3) << st.nanoseconds / 1e6
+           << std::setw(14) << std::setprecision(1)
+           << static_cast<double>(st.allocations) / st.calls << "\n";
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
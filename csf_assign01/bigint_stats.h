@@ -0,0 +1,104 @@
+#ifndef BIGINT_STATS_H
+#define BIGINT_STATS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <iosfwd>
+
+//! @file
+//! Opt-in per-operation instrumentation counters for BigInt.
+//!
+//! Counting is compiled in only when `BIGINT_INSTRUMENT` is defined
+//! (`make INSTRUMENT=1`); otherwise the `BIGINT_OP_SCOPE` and
+//! `BIGINT_NOTE_ALLOC` hooks expand to nothing and the query functions
+//! below report zeros. Counters are kept per thread and summed on
+//! demand. If the environment variable `BIGINT_STATS` is set to a
+//! non-empty value other than `0`, a report is written to `stderr`
+//! when the program exits.
+
+//! Operations that are counted.
+enum class BigIntOp {
+  ADD,         //!< addition (`+`)
+  SUB,         //!< subtraction (binary `-`)
+  NEG,         //!< negation (unary `-`)
+  MUL,         //!< multiplication (`*`)
+  DIV,         //!< division (`/`)
+  LSHIFT,      //!< left shift (`<<`)
+  COMPARE,     //!< comparison
+  TO_HEX,      //!< hexadecimal conversion
+  TO_DEC,      //!< decimal conversion
+  COPY,        //!< copy construction and assignment
+  COUNT        //!< number of operations (not an operation)
+};
+
+//! Counters for one operation. Limbs, allocations, bytes and time are
+//! inclusive: an allocation made by the addition inside a subtraction
+//! counts toward both `ADD` and `SUB`.
+struct BigIntOpStats {
+  uint64_t calls;            //!< number of calls
+  uint64_t limbs;            //!< total operand limbs processed
+  uint64_t allocations;      //!< limb buffers allocated (one per BigInt value created)
+  uint64_t bytes_allocated;  //!< bytes in those limb buffers
+  uint64_t nanoseconds;      //!< wall-clock time spent
+};
+
+//! @return true if instrumentation was compiled in
+bool bigint_stats_enabled();
+
+//! @param op an operation
+//! @return the operation's name, e.g. "to_dec"
+const char *bigint_op_name(BigIntOp op);
+
+//! Sum the counters for one operation over all threads (including
+//! threads that have exited).
+//!
+//! @param op the operation
+//! @return the aggregated counters
+BigIntOpStats bigint_stats_get(BigIntOp op);
+
+//! Reset the counters of every thread to zero. Other threads' counters
+//! are not written (only their owners do that): their current values
+//! become a baseline that later reads subtract, so this is safe to
+//! call while other threads are counting.
+void bigint_stats_reset();
+
+//! Write a report of the aggregated counters (one line per operation
+//! that was called) to a stream.
+//!
+//! @param os the stream to write to
+void bigint_stats_dump(std::ostream &os);
+
+#ifdef BIGINT_INSTRUMENT
+
+//! Record a limb buffer allocation against every operation currently
+//! running on this thread.
+//!
+//! @param bytes size of the allocation
+void bigint_stats_note_alloc(size_t bytes);
+
+//! RAII helper that counts one call to an operation, and the time until
+//! the end of the enclosing scope. Use through `BIGINT_OP_SCOPE`.
+class BigIntOpScope {
+private:
+   BigIntOp op;
+   std::chrono::steady_clock::time_point start;
+
+public:
+  BigIntOpScope(BigIntOp op, size_t limbs);
+  ~BigIntOpScope();
+  BigIntOpScope(const BigIntOpScope &) = delete;
+  BigIntOpScope &operator=(const BigIntOpScope &) = delete;
+};
+
+#define BIGINT_OP_SCOPE(op, limbs) BigIntOpScope bigint_op_scope_(op, limbs)
+#define BIGINT_NOTE_ALLOC(bytes) bigint_stats_note_alloc(bytes)
+
+#else
+
+#define BIGINT_OP_SCOPE(op, limbs) ((void) 0)
+#define BIGINT_NOTE_ALLOC(bytes) ((void) 0)
+
+#endif // BIGINT_INSTRUMENT
+
+#endif // BIGINT_STATS_H
@@ -1,7 +1,24 @@
 #include <stdexcept>
 #include <sstream>
 #include <iostream>
+#include <iomanip>
+#include <thread>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <unistd.h>
 #include "bigint.h"
+#include "bigint_batch.h"
+#include "bigint_mmap.h"
+#include "bigint_stats.h"
+#include "bigint_math.h"
+#include "bigint_montgomery.h"
+#include "bigint_mpn.h"
+#include "bigint_accumulator.h"
+#include "bigint_rational.h"
+#include "bigint_float.h"
+#include "bigint_modint.h"
+#include "bigint_rns.h"
 #include "tctest.h"
 
 struct TestObjs {
@@ -138,6 +155,46 @@ void test_copy_constructor(TestObjs *objs);
 void test_single_uint64_constructor(TestObjs *objs);
 void test_initializer_list_constructor(TestObjs *objs);
 void test_default_constructor(TestObjs *objs);
+void test_mul_karatsuba(TestObjs *objs);
+void test_mul_parallel(TestObjs *objs);
+void test_batch_pack_unpack(TestObjs *objs);
+void test_batch_add_sub(TestObjs *objs);
+void test_batch_mul_mod(TestObjs *objs);
+void test_add_sub_carry_chain(TestObjs *objs);
+void test_view_basic(TestObjs *objs);
+void test_view_arithmetic(TestObjs *objs);
+void test_serialize(TestObjs *objs);
+void test_to_from_bytes(TestObjs *objs);
+void test_mapped_create_open(TestObjs *objs);
+void test_mapped_arithmetic(TestObjs *objs);
+void test_stats(TestObjs *objs);
+void test_product(TestObjs *objs);
+void test_factorial(TestObjs *objs);
+void test_binomial(TestObjs *objs);
+void test_rshift(TestObjs *objs);
+void test_isqrt(TestObjs *objs);
+void test_montgomery(TestObjs *objs);
+void test_is_probable_prime(TestObjs *objs);
+void test_next_prime(TestObjs *objs);
+void test_random_bits(TestObjs *objs);
+void test_random_below(TestObjs *objs);
+void test_stream_output(TestObjs *objs);
+void test_copy_on_write(TestObjs *objs);
+void test_mpn_kernels(TestObjs *objs);
+void test_div_large(TestObjs *objs);
+void test_divrem_limb(TestObjs *objs);
+void test_mixed_word_ops(TestObjs *objs);
+void test_addmul_submul(TestObjs *objs);
+void test_accumulator(TestObjs *objs);
+void test_lazy_normalization(TestObjs *objs);
+void test_radix_conversion(TestObjs *objs);
+void test_double_conversion(TestObjs *objs);
+void test_bit_queries(TestObjs *objs);
+void test_gcd(TestObjs *objs);
+void test_rational(TestObjs *objs);
+void test_bigfloat(TestObjs *objs);
+void test_modint(TestObjs *objs);
+void test_rns(TestObjs *objs);
 
 
 
@@ -238,6 +295,46 @@ int main(int argc, char **argv) {
   TEST(test_initializer_list_constructor);
   TEST(test_single_uint64_constructor);
   TEST(test_copy_constructor);
+  TEST(test_mul_karatsuba);
+  TEST(test_mul_parallel);
+  TEST(test_batch_pack_unpack);
+  TEST(test_batch_add_sub);
+  TEST(test_batch_mul_mod);
+  TEST(test_add_sub_carry_chain);
+  TEST(test_view_basic);
+  TEST(test_view_arithmetic);
+  TEST(test_serialize);
+  TEST(test_to_from_bytes);
+  TEST(test_mapped_create_open);
+  TEST(test_mapped_arithmetic);
+  TEST(test_stats);
+  TEST(test_product);
+  TEST(test_factorial);
+  TEST(test_binomial);
+  TEST(test_rshift);
+  TEST(test_isqrt);
+  TEST(test_montgomery);
+  TEST(test_is_probable_prime);
+  TEST(test_next_prime);
+  TEST(test_random_bits);
+  TEST(test_random_below);
+  TEST(test_stream_output);
+  TEST(test_copy_on_write);
+  TEST(test_mpn_kernels);
+  TEST(test_div_large);
+  TEST(test_divrem_limb);
+  TEST(test_mixed_word_ops);
+  TEST(test_addmul_submul);
+  TEST(test_accumulator);
+  TEST(test_lazy_normalization);
+  TEST(test_radix_conversion);
+  TEST(test_double_conversion);
+  TEST(test_bit_queries);
+  TEST(test_gcd);
+  TEST(test_rational);
+  TEST(test_bigfloat);
+  TEST(test_modint);
+  TEST(test_rns);
 
 
 
@@ -1827,3 +1924,1725 @@ void test_copy_constructor(TestObjs *objs) {
     ASSERT(!copy3.is_negative());  // Sign should match the original (non-negative)
     ASSERT(original3.get_bit_vector() == copy3.get_bit_vector());  
 }
+
+void test_mul_karatsuba(TestObjs *objs) {
+    // (2^n - 1)^2 = 2^2n - 2^(n+1) + 1, for operand sizes on both
+    // sides of the Karatsuba threshold and unbalanced operands
+    for (unsigned limbs : {1U, 31U, 32U, 33U, 100U, 257U}) {
+        unsigned n = limbs * 64;
+        BigInt ones = (objs->one << n) - objs->one;
+        BigInt expected = (objs->one << (2 * n)) - (objs->one << (n + 1)) + objs->one;
+        ASSERT(ones * ones == expected);
+        ASSERT(-ones * ones == -expected);
+    }
+
+    // Unbalanced: (2^6400 - 1) * (2^2112 - 1)
+    BigInt a = (objs->one << 6400) - objs->one;
+    BigInt b = (objs->one << 2112) - objs->one;
+    BigInt expected = (objs->one << 8512) - (objs->one << 6400) - (objs->one << 2112) + objs->one;
+    ASSERT(a * b == expected);
+    ASSERT(b * a == expected);
+}
+
+void test_mul_parallel(TestObjs *objs) {
+    unsigned n = BigInt::PARALLEL_MUL_THRESHOLD * 64;
+    BigInt ones = (objs->one << n) - objs->one;
+    BigInt expected = (objs->one << (2 * n)) - (objs->one << (n + 1)) + objs->one;
+
+    unsigned saved = BigInt::get_max_threads();
+
+    BigInt::set_max_threads(1);
+    ASSERT(BigInt::get_max_threads() == 1);
+    ASSERT(ones * ones == expected);
+
+    BigInt::set_max_threads(4);
+    ASSERT(BigInt::get_max_threads() == 4);
+    ASSERT(ones * ones == expected);
+
+    BigInt::set_max_threads(saved);
+}
+
+void test_batch_pack_unpack(TestObjs *objs) {
+    std::vector<BigInt> vals = { objs->zero, objs->u64_max, objs->two_pow_64, objs->large_positive };
+    BigIntBatch batch = BigIntBatch::pack(vals, 3);
+    ASSERT(batch.size() == 4);
+    ASSERT(batch.limbs() == 3);
+
+    // limb 0 of every element is contiguous
+    ASSERT(batch.row(0)[1] == 0xFFFFFFFFFFFFFFFFUL);
+    ASSERT(batch.row(1)[2] == 1UL);
+    ASSERT(batch.row(2)[3] == 0UL);
+
+    std::vector<BigInt> back = batch.unpack();
+    ASSERT(back.size() == vals.size());
+    for (size_t i = 0; i < vals.size(); ++i) {
+        ASSERT(back[i] == vals[i]);
+    }
+
+    // negative values and values that are too wide are rejected
+    try {
+        BigIntBatch::pack({ objs->negative_one }, 1);
+        FAIL("negative value was packed");
+    } catch (std::invalid_argument &ex) {
+        // good
+    }
+    try {
+        BigIntBatch::pack({ objs->two_pow_64 }, 1);
+        FAIL("oversized value was packed");
+    } catch (std::invalid_argument &ex) {
+        // good
+    }
+}
+
+void test_batch_add_sub(TestObjs *objs) {
+    std::vector<BigInt> a_vals, b_vals;
+    for (unsigned i = 0; i < 100; ++i) {
+        a_vals.push_back((objs->one << (i + 60)) - BigInt(i));
+        b_vals.push_back(BigInt(0xFFFFFFFFFFFFFFFFUL - i));
+    }
+    BigIntBatch a = BigIntBatch::pack(a_vals, 4);
+    BigIntBatch b = BigIntBatch::pack(b_vals, 4);
+    BigIntBatch out(100, 4);
+
+    std::vector<uint64_t> carry(100);
+    BigIntBatch::add(out, a, b, carry.data());
+    for (unsigned i = 0; i < 100; ++i) {
+        ASSERT(out.get(i) == a_vals[i] + b_vals[i]);
+        ASSERT(carry[i] == 0);
+    }
+
+    BigIntBatch::sub(out, a, b, carry.data());
+    for (unsigned i = 0; i < 100; ++i) {
+        if (a_vals[i] >= b_vals[i]) {
+            ASSERT(out.get(i) == a_vals[i] - b_vals[i]);
+            ASSERT(carry[i] == 0);
+        } else {
+            // wraps modulo 2^256
+            ASSERT(out.get(i) == (objs->one << 256) + a_vals[i] - b_vals[i]);
+            ASSERT(carry[i] == 1);
+        }
+    }
+
+    // carry out of the top limb
+    BigIntBatch max = BigIntBatch::pack({ objs->large_positive }, 2);
+    BigIntBatch one = BigIntBatch::pack({ objs->one }, 2);
+    BigIntBatch::add(max, max, one, carry.data());
+    ASSERT(max.get(0).is_zero());
+    ASSERT(carry[0] == 1);
+}
+
+void test_batch_mul_mod(TestObjs *objs) {
+    // modulus 2^192 - 237 (odd), elements spanning several tiles
+    BigInt modulus = (objs->one << 192) - BigInt(237);
+    std::vector<BigInt> a_vals, b_vals;
+    for (unsigned i = 0; i < 150; ++i) {
+        a_vals.push_back(modulus - BigInt(i * 7919 + 1));
+        b_vals.push_back((objs->one << (i % 190)) + BigInt(i));
+    }
+    BigIntBatch a = BigIntBatch::pack(a_vals, 3);
+    BigIntBatch b = BigIntBatch::pack(b_vals, 3);
+    BigIntBatch::mul_mod(a, a, b, modulus);
+
+    for (unsigned i = 0; i < 150; ++i) {
+        BigInt product = a_vals[i] * b_vals[i];
+        BigInt expected = product - (product / modulus) * modulus;
+        ASSERT(a.get(i) == expected);
+    }
+
+    try {
+        BigIntBatch::mul_mod(a, a, b, BigInt(1UL << 20));
+        FAIL("even modulus was accepted");
+    } catch (std::invalid_argument &ex) {
+        // good
+    }
+}
+
+void test_add_sub_carry_chain(TestObjs *objs) {
+    // a carry (or borrow) arriving at an all-ones limb must propagate
+    BigInt a({ 0xFFFFFFFFFFFFFFFFUL, 0x1UL });
+    BigInt b({ 0x1UL, 0xFFFFFFFFFFFFFFFFUL });
+    check_contents(a + b, { 0x0UL, 0x1UL, 0x1UL });
+
+    BigInt c({ 0x0UL, 0x0UL, 0x1UL });
+    BigInt d({ 0x1UL, 0xFFFFFFFFFFFFFFFFUL });
+    check_contents(c - d, { 0xFFFFFFFFFFFFFFFFUL, 0x0UL });
+}
+
+void test_view_basic(TestObjs *objs) {
+    // view over external memory, with leading zero limbs ignored
+    uint64_t limbs[] = { 0x0UL, 0x1UL, 0x0UL, 0x0UL };
+    BigIntView v(limbs, 4);
+    ASSERT(v.size() == 2);
+    ASSERT(v.data() == limbs);
+    ASSERT(!v.is_negative());
+    ASSERT(v.get_bits(1) == 1UL);
+    ASSERT(v.get_bits(5) == 0UL);
+    ASSERT(v.to_hex() == "10000000000000000");
+    ASSERT(v.to_dec() == "18446744073709551616");
+    ASSERT(v == objs->two_pow_64);
+    ASSERT(objs->two_pow_64 == v);
+    check_contents(v.to_bigint(), { 0x0UL, 0x1UL });
+
+    BigIntView neg(limbs, 4, true);
+    ASSERT(neg.is_negative());
+    ASSERT(neg.to_hex() == "-10000000000000000");
+    ASSERT(neg == objs->negative_two_pow_64);
+    ASSERT(neg < v);
+    ASSERT(-neg == v);
+
+    // zero is never negative, whatever the flag says
+    BigIntView zero(limbs, 1, true);
+    ASSERT(zero.is_zero());
+    ASSERT(!zero.is_negative());
+    ASSERT(zero.to_hex() == "0");
+    ASSERT(zero == objs->zero);
+
+    // views of BigInt objects share their storage
+    BigIntView of_big(objs->large_negative);
+    ASSERT(of_big.data() == objs->large_negative.get_bit_vector().data());
+    ASSERT(of_big.is_negative());
+    ASSERT(of_big.compare(objs->large_positive) < 0);
+}
+
+void test_view_arithmetic(TestObjs *objs) {
+    uint64_t a_limbs[] = { 0xFFFFFFFFFFFFFFFFUL, 0xFFFFFFFFFFFFFFFFUL };
+    uint64_t b_limbs[] = { 0x9UL };
+    BigIntView a(a_limbs, 2);
+    BigIntView b(b_limbs, 1, true);
+
+    ASSERT(a + b == objs->large_positive - objs->nine);
+    ASSERT(a - b == objs->large_positive + objs->nine);
+    ASSERT(a * b == objs->large_positive * objs->negative_nine);
+    ASSERT(b * b == BigInt(81));
+
+    // mixing BigInt and BigIntView operands
+    ASSERT(objs->three + b == BigInt(6, true));
+    ASSERT(objs->three - b == BigInt(12));
+    ASSERT(objs->three * b == BigInt(27, true));
+    ASSERT(b + objs->three == BigInt(6, true));
+    ASSERT(a + -a == objs->zero);
+}
+
+void test_serialize(TestObjs *objs) {
+    std::vector<uint8_t> buf = objs->negative_two_pow_64.serialize();
+    ASSERT(buf.size() == objs->negative_two_pow_64.serialized_size());
+    ASSERT(buf.size() == 24);
+    ASSERT(buf[0] == 5);   // (2 limbs << 1) | negative
+    ASSERT(buf[16] == 1);  // low byte of limb 1
+
+    BigInt back = BigInt::deserialize(buf.data(), buf.size());
+    ASSERT(back == objs->negative_two_pow_64);
+
+    // zero has no limbs
+    ASSERT(objs->zero.serialized_size() == 8);
+    ASSERT(BigInt::deserialize(objs->zero.serialize().data(), 8) == objs->zero);
+
+    // zero-copy view into an aligned buffer
+    std::vector<uint64_t> aligned(3);
+    objs->large_positive.serialize(reinterpret_cast<uint8_t *>(aligned.data()));
+    BigIntView view = BigInt::deserialize_view(reinterpret_cast<const uint8_t *>(aligned.data()), 24);
+    ASSERT(view.data() == aligned.data() + 1);
+    ASSERT(view == objs->large_positive);
+
+    try {
+        BigInt::deserialize(buf.data(), buf.size() - 1);
+        FAIL("truncated data was accepted");
+    } catch (std::invalid_argument &ex) {
+        // good
+    }
+    try {
+        BigInt::deserialize_view(reinterpret_cast<const uint8_t *>(aligned.data()) + 1, 16);
+        FAIL("misaligned data was accepted");
+    } catch (std::invalid_argument &ex) {
+        // good
+    }
+}
+
+void test_to_from_bytes(TestObjs *objs) {
+    std::vector<uint8_t> bytes = BigInt(0x1234UL, true).to_bytes();
+    ASSERT(bytes == std::vector<uint8_t>({ 0x05, 0x12, 0x34 }));
+
+    bytes = objs->zero.to_bytes();
+    ASSERT(bytes == std::vector<uint8_t>({ 0x00 }));
+
+    // 2^64 needs 9 magnitude bytes
+    bytes = objs->two_pow_64.to_bytes();
+    ASSERT(bytes.size() == 10);
+    ASSERT(bytes[0] == 18);
+    ASSERT(bytes[1] == 1);
+
+    // multi-byte LEB128 header, and values read back to back
+    BigInt big = (objs->one << 600) - objs->three;
+    std::vector<uint8_t> stream = big.to_bytes();
+    ASSERT(stream[0] == (0x80 | ((75 << 1) & 0x7F)));
+    ASSERT(stream[1] == ((75 << 1) >> 7));
+    std::vector<uint8_t> second = objs->large_negative.to_bytes();
+    stream.insert(stream.end(), second.begin(), second.end());
+
+    size_t used;
+    BigInt a = BigInt::from_bytes(stream.data(), stream.size(), &used);
+    ASSERT(a == big);
+    BigInt b = BigInt::from_bytes(stream.data() + used, stream.size() - used);
+    ASSERT(b == objs->large_negative);
+
+    try {
+        BigInt::from_bytes(stream.data(), 10);
+        FAIL("truncated bytes were accepted");
+    } catch (std::invalid_argument &ex) {
+        // good
+    }
+
+    // headers with bits beyond 64, or with zero padding, are rejected
+    std::vector<uint8_t> overflow(9, 0x80);
+    overflow.push_back(0x02);
+    std::vector<uint8_t> padded({ 0x80, 0x00 });
+    for (const std::vector<uint8_t> &bad : { overflow, padded }) {
+        try {
+            BigInt::from_bytes(bad.data(), bad.size());
+            FAIL("overlong header was accepted");
+        } catch (std::invalid_argument &ex) {
+            // good
+        }
+    }
+}
+
+void test_mapped_create_open(TestObjs *objs) {
+    std::string path = "/tmp/bigint_tests_mapped_" + std::to_string(getpid());
+    BigInt val = (objs->one << 300) - objs->nine;
+
+    {
+        MappedBigInt m = MappedBigInt::create(path, -val, 10);
+        ASSERT(m.capacity() == 10);
+        ASSERT(m.view() == -val);
+        ASSERT(m.view().to_hex() == (-val).to_hex());
+        m.sync();
+    }
+
+    // the file is in the BigInt::serialize layout
+    {
+        MappedBigInt m = MappedBigInt::open(path);
+        ASSERT(m.to_bigint() == -val);
+        std::vector<uint8_t> expected = (-val).serialize();
+        ASSERT(BigInt::deserialize(expected.data(), expected.size()) == m.view());
+    }
+
+    // an empty file is not a serialized BigInt
+    MappedBigInt::create(path, 0);
+    truncate(path.c_str(), 4);
+    try {
+        MappedBigInt::open(path);
+        FAIL("malformed file was opened");
+    } catch (std::invalid_argument &ex) {
+        // good
+    }
+    unlink(path.c_str());
+}
+
+void test_mapped_arithmetic(TestObjs *objs) {
+    std::string path_a = "/tmp/bigint_tests_mapped_a_" + std::to_string(getpid());
+    std::string path_b = "/tmp/bigint_tests_mapped_b_" + std::to_string(getpid());
+    std::string path_r = "/tmp/bigint_tests_mapped_r_" + std::to_string(getpid());
+
+    BigInt a_val = (objs->one << 1000) - (objs->one << 500) + objs->three;
+    BigInt b_val = (objs->one << 700) - objs->one;
+    MappedBigInt a = MappedBigInt::create(path_a, a_val);
+    MappedBigInt b = MappedBigInt::create(path_b, -b_val);
+    MappedBigInt r = MappedBigInt::create(path_r, 40);
+
+    MappedBigInt::add(r, a.view(), b.view());
+    ASSERT(r.view() == a_val - b_val);
+    MappedBigInt::sub(r, a.view(), b.view());
+    ASSERT(r.view() == a_val + b_val);
+    MappedBigInt::sub(r, b.view(), a.view());
+    ASSERT(r.view() == -b_val - a_val);
+
+    // in place: r = r + a
+    MappedBigInt::add(r, r.view(), a.view());
+    ASSERT(r.view() == -b_val);
+
+    MappedBigInt::shift_left(r, a.view(), 130);
+    ASSERT(r.view() == a_val << 130);
+    MappedBigInt::shift_left(r, r.view(), 64);
+    ASSERT(r.view() == a_val << 194);
+
+    // blocked multiplication, with blocks much smaller than the operands
+    MappedBigInt::multiply(r, a.view(), b.view(), 3);
+    ASSERT(r.view() == a_val * -b_val);
+    MappedBigInt::multiply(r, a.view(), a.view());
+    ASSERT(r.view() == a_val * a_val);
+
+    MappedBigInt small = MappedBigInt::create(path_r + "_small", 2);
+    try {
+        MappedBigInt::multiply(small, a.view(), b.view());
+        FAIL("undersized result was accepted");
+    } catch (std::invalid_argument &ex) {
+        // good
+    }
+
+    // a file opened read-only can't receive a result
+    r.sync();
+    MappedBigInt read_only = MappedBigInt::open(path_r);
+    ASSERT(!read_only.is_writable() && MappedBigInt::open(path_r, true).is_writable());
+    try {
+        MappedBigInt::add(read_only, a.view(), b.view());
+        FAIL("read-only result was written");
+    } catch (std::invalid_argument &ex) {
+        // good
+    }
+    try {
+        MappedBigInt::shift_left(read_only, a.view(), 1);
+        FAIL("read-only result was written");
+    } catch (std::invalid_argument &ex) {
+        // good
+    }
+    ASSERT(read_only.view() == a_val * a_val);
+
+    unlink(path_a.c_str());
+    unlink(path_b.c_str());
+    unlink(path_r.c_str());
+    unlink((path_r + "_small").c_str());
+}
+
+void test_stats(TestObjs *objs) {
+    bigint_stats_reset();
+    BigInt sum = objs->large_positive + objs->two_pow_64;
+    std::string dec = objs->nine.to_dec();
+    BigInt quotient = objs->large_positive / objs->three;
+    BigInt difference = sum - objs->three;
+    BigInt copy = sum;
+
+    BigIntOpStats add = bigint_stats_get(BigIntOp::ADD);
+    BigIntOpStats to_dec = bigint_stats_get(BigIntOp::TO_DEC);
+    BigIntOpStats div = bigint_stats_get(BigIntOp::DIV);
+    BigIntOpStats sub = bigint_stats_get(BigIntOp::SUB);
+    BigIntOpStats copies = bigint_stats_get(BigIntOp::COPY);
+
+    std::stringstream report;
+    report.precision(9);
+    bigint_stats_dump(report);
+    ASSERT(!report.str().empty());
+    // the caller's formatting is left as it was
+    ASSERT(report.precision() == 9);
+    ASSERT((report.flags() & (std::ios::fixed | std::ios::left)) == 0);
+    ASSERT(std::string(bigint_op_name(BigIntOp::TO_DEC)) == "to_dec");
+
+    if (!bigint_stats_enabled()) {
+        ASSERT(add.calls == 0);
+        ASSERT(to_dec.calls == 0);
+        return;
+    }
+
+    // one explicit add plus the one made inside the subtraction
+    ASSERT(add.calls == 2);
+    ASSERT(add.limbs >= 4);
+    ASSERT(add.allocations >= 1);
+    ASSERT(to_dec.calls == 1);
+    ASSERT(div.calls == 1);
+    ASSERT(div.allocations >= 1);
+    ASSERT(div.bytes_allocated >= 8 * div.allocations);
+    // allocations are inclusive: the subtraction counts those of its addition
+    ASSERT(sub.calls == 1);
+    ASSERT(sub.allocations >= 1);
+    ASSERT(add.allocations >= sub.allocations);
+    ASSERT(copies.calls >= 1);
+    ASSERT(report.str().find("to_dec") != std::string::npos);
+
+    // a multi-limb divisor takes the Algorithm D path, which is counted
+    // as one division of both operands' limbs, with its allocations
+    BigInt dividend = objs->large_positive << 200, divisor = objs->two_pow_64 + objs->three;
+    bigint_stats_reset();
+    BigInt long_quotient = dividend / divisor;
+    BigIntOpStats long_div = bigint_stats_get(BigIntOp::DIV);
+    ASSERT(long_div.calls == 1);
+    ASSERT(long_div.limbs == BigIntView(dividend).size() + 2);
+    ASSERT(long_div.allocations >= 1);
+    ASSERT(long_quotient * divisor + dividend % divisor == dividend);
+
+    // counters from other threads are aggregated, including after they exit
+    bigint_stats_reset();
+    std::thread worker([objs]() { BigInt x = objs->three * objs->nine; });
+    worker.join();
+    ASSERT(bigint_stats_get(BigIntOp::MUL).calls == 1);
+}
+
+void test_product(TestObjs *objs) {
+    ASSERT(product(std::vector<BigInt>()) == objs->one);
+    ASSERT(product({ objs->negative_three }) == objs->negative_three);
+    ASSERT(product({ objs->three, objs->negative_nine, objs->two }) == BigInt(54, true));
+
+    // 2^64 - 1 multiplied 200 times, in a tree large enough to use threads
+    std::vector<BigInt> vals(200, objs->u64_max);
+    BigInt expected = objs->one;
+    for (const BigInt &v : vals) {
+        expected = expected * v;
+    }
+    unsigned saved = BigInt::get_max_threads();
+    BigInt::set_max_threads(4);
+    ASSERT(product(vals) == expected);
+    BigInt::set_max_threads(1);
+    ASSERT(product(vals.data(), vals.size()) == expected);
+
+    // worker threads come from one budget of max_threads - 1 slots
+    BigInt::set_max_threads(3);
+    {
+        BigInt::ThreadSlot first, second, third;
+        ASSERT(first.acquire() && second.acquire() && !third.acquire());
+        // with the budget used up, the product runs on this thread
+        ASSERT(product(vals) == expected);
+        first.release();
+        ASSERT(third.acquire());
+    }
+    BigInt::ThreadSlot slot;
+    ASSERT(slot.acquire());
+    BigInt::set_max_threads(saved);
+}
+
+void test_factorial(TestObjs *objs) {
+    ASSERT(factorial(0) == objs->one);
+    ASSERT(factorial(1) == objs->one);
+    ASSERT(factorial(2) == objs->two);
+    ASSERT(factorial(20) == BigInt(2432902008176640000UL));
+    ASSERT(factorial(30).to_dec() == "265252859812191058636308480000000");
+
+    BigInt expected = objs->one;
+    for (uint64_t i = 2; i <= 300; ++i) {
+        expected = expected * BigInt(i);
+    }
+    ASSERT(factorial(300) == expected);
+}
+
+void test_binomial(TestObjs *objs) {
+    ASSERT(binomial(0, 0) == objs->one);
+    ASSERT(binomial(5, 0) == objs->one);
+    ASSERT(binomial(5, 5) == objs->one);
+    ASSERT(binomial(5, 6) == objs->zero);
+    ASSERT(binomial(5, 2) == BigInt(10));
+    ASSERT(binomial(64, 32) == BigInt(1832624140942590534UL));
+    ASSERT(binomial(100, 50).to_dec() == "100891344545564193334812497256");
+
+    // C(n, k) * k! * (n-k)! = n!
+    ASSERT(binomial(250, 83) * factorial(83) * factorial(167) == factorial(250));
+
+    // large n with small k doesn't sieve up to n
+    BigInt t12 = BigInt::from_string("1000000000000");
+    ASSERT(binomial(1000000000000UL, 2) == t12 * (t12 - objs->one) / objs->two);
+    ASSERT(binomial(UINT64_MAX, 1) == objs->u64_max);
+    ASSERT(binomial(UINT64_MAX, UINT64_MAX - 1) == objs->u64_max);
+    ASSERT(binomial(UINT64_MAX, 3) == objs->u64_max * (objs->u64_max - objs->one) * (objs->u64_max - objs->two) / BigInt(6));
+    ASSERT(binomial(1000, 20) * factorial(20) * factorial(980) == factorial(1000));
+}
+
+void test_rshift(TestObjs *objs) {
+    check_contents(objs->two_pow_64 >> 1, { 0x8000000000000000UL });
+    check_contents(objs->two_pow_64 >> 64, { 1UL });
+    check_contents(objs->two_pow_64 >> 65, { 0UL });
+    check_contents(objs->large_positive >> 4, { 0xFFFFFFFFFFFFFFFFUL, 0x0FFFFFFFFFFFFFFFUL });
+    check_contents(objs->large_positive >> 200, { 0UL });
+    ASSERT(((objs->nine << 300) >> 300) == objs->nine);
+
+    try {
+        objs->negative_nine >> 1;
+        FAIL("negative values can't be shifted");
+    } catch (std::invalid_argument &ex) {
+        // good
+    }
+}
+
+void test_isqrt(TestObjs *objs) {
+    ASSERT(isqrt(objs->zero) == objs->zero);
+    ASSERT(isqrt(objs->one) == objs->one);
+    ASSERT(isqrt(objs->three) == objs->one);
+    ASSERT(isqrt(objs->nine) == objs->three);
+    ASSERT(isqrt(objs->u64_max) == BigInt(0xFFFFFFFFUL));
+    ASSERT(isqrt(objs->two_pow_64) == BigInt(0x100000000UL));
+
+    BigInt r = (objs->one << 200) + BigInt(12345);
+    ASSERT(isqrt(r * r) == r);
+    ASSERT(isqrt(r * r - objs->one) == r - objs->one);
+    ASSERT(isqrt(r * r + r + r) == r);
+
+    try {
+        isqrt(objs->negative_nine);
+        FAIL("square root of a negative value");
+    } catch (std::invalid_argument &ex) {
+        // good
+    }
+}
+
+void test_montgomery(TestObjs *objs) {
+    BigInt modulus = (objs->one << 127) - objs->one;
+    MontgomeryContext ctx(modulus);
+    ASSERT(ctx.limbs() == 2);
+    ASSERT(ctx.modulus() == modulus);
+
+    uint64_t a[2], b[2], r[2];
+    BigInt x = (objs->one << 100) + objs->nine;
+    ctx.to_mont(a, x);
+    ctx.to_mont(b, objs->negative_three);
+    ASSERT(ctx.from_mont(a) == x);
+    ASSERT(ctx.from_mont(b) == modulus - objs->three);
+
+    // x * -3 = -(3x) mod N
+    ctx.mul(r, a, b);
+    ASSERT(ctx.from_mont(r) == modulus - x * objs->three);
+    ctx.add(r, a, b);
+    ASSERT(ctx.from_mont(r) == x - objs->three);
+    ctx.sub(r, b, a);
+    ASSERT(ctx.from_mont(r) == modulus - objs->three - x);
+    ctx.half(r, b);
+    ctx.add(r, r, r);
+    ASSERT(ctx.equal(r, b));
+
+    // values wider than the modulus are reduced: 2^127 = 1 mod N
+    ctx.to_mont(r, objs->one << 400);
+    ASSERT(ctx.from_mont(r) == BigInt(1UL << (400 % 127)));
+
+    // Fermat: 3^(N-1) = 1 for the prime N = 2^127 - 1
+    uint64_t one[2];
+    ctx.one(one);
+    ctx.to_mont(a, objs->three);
+    ctx.pow(r, a, modulus - objs->one);
+    ASSERT(ctx.equal(r, one));
+    ctx.pow(r, a, BigInt(5));
+    ASSERT(ctx.from_mont(r) == BigInt(243));
+
+    try {
+        MontgomeryContext even(objs->two_pow_64);
+        FAIL("even modulus was accepted");
+    } catch (std::invalid_argument &ex) {
+        // good
+    }
+}
+
+void test_is_probable_prime(TestObjs *objs) {
+    ASSERT(!is_probable_prime(objs->zero));
+    ASSERT(!is_probable_prime(objs->one));
+    ASSERT(is_probable_prime(objs->two));
+    ASSERT(is_probable_prime(objs->three));
+    ASSERT(!is_probable_prime(objs->nine));
+    ASSERT(!is_probable_prime(objs->negative_three));
+    ASSERT(is_probable_prime(BigInt(2039)));
+    ASSERT(!is_probable_prime(BigInt(561)));            // Carmichael number
+    ASSERT(is_probable_prime(BigInt(4194301)));         // past the trial division table
+    ASSERT(!is_probable_prime(BigInt(4194303)));
+
+    // Mersenne numbers 2^p - 1
+    ASSERT(is_probable_prime((objs->one << 61) - objs->one));
+    ASSERT(!is_probable_prime((objs->one << 67) - objs->one));
+    ASSERT(is_probable_prime((objs->one << 127) - objs->one));
+    ASSERT(is_probable_prime((objs->one << 521) - objs->one));
+    ASSERT(!is_probable_prime((objs->one << 523) - objs->one));
+
+    // strong pseudoprime to bases 2 through 23, with no small factors:
+    // only the Lucas part of the test can reject it
+    BigInt spsp(3825123056546413051UL);
+    ASSERT(!is_probable_prime(spsp, 0));
+    ASSERT(!is_probable_prime(spsp));
+
+    // product of two primes, and a perfect square
+    BigInt p = (objs->one << 89) - objs->one;
+    BigInt q = (objs->one << 107) - objs->one;
+    ASSERT(!is_probable_prime(p * q));
+    ASSERT(!is_probable_prime(p * p));
+}
+
+void test_next_prime(TestObjs *objs) {
+    ASSERT(next_prime(objs->negative_nine) == objs->two);
+    ASSERT(next_prime(objs->zero) == objs->two);
+    ASSERT(next_prime(objs->two) == objs->three);
+    ASSERT(next_prime(BigInt(100)) == BigInt(101));
+    ASSERT(next_prime(BigInt(2040)) == BigInt(2053));
+    ASSERT(next_prime(BigInt(1000000)) == BigInt(1000003));
+    ASSERT(next_prime(objs->u64_max) == objs->two_pow_64 + BigInt(13));
+    ASSERT(next_prime((objs->one << 127) - objs->two) == (objs->one << 127) - objs->one);
+}
+
+void test_random_bits(TestObjs *objs) {
+    std::mt19937_64 rng(12345);
+
+    ASSERT(BigInt::random_bits(0, rng) == objs->zero);
+
+    BigInt limit = objs->one << 200;
+    bool top_bit_seen = false;
+    for (int i = 0; i < 50; ++i) {
+        BigInt r = BigInt::random_bits(200, rng);
+        ASSERT(!r.is_negative());
+        ASSERT(r < limit);
+        top_bit_seen = top_bit_seen || r.is_bit_set(199);
+    }
+    ASSERT(top_bit_seen);
+
+    // the same seed gives the same value; whole limbs come from the engine
+    std::mt19937_64 a(7), b(7);
+    BigInt x = BigInt::random_bits(128, a);
+    uint64_t lo = b(), hi = b();
+    check_contents(x, { lo, hi });
+
+    // works with 32-bit engines too
+    std::mt19937 rng32(99);
+    ASSERT(BigInt::random_bits(70, rng32) < (objs->one << 70));
+}
+
+void test_random_below(TestObjs *objs) {
+    std::mt19937_64 rng(2024);
+
+    for (int i = 0; i < 20; ++i) {
+        ASSERT(BigInt::random_below(objs->one, rng) == objs->zero);
+    }
+
+    // all values of a small range show up
+    bool seen[9] = { false };
+    for (int i = 0; i < 500; ++i) {
+        BigInt r = BigInt::random_below(objs->nine, rng);
+        ASSERT(r >= objs->zero && r < objs->nine);
+        seen[r.get_bits(0)] = true;
+    }
+    for (bool s : seen) {
+        ASSERT(s);
+    }
+
+    // a bound just above a power of two rejects about half the draws
+    BigInt bound = (objs->one << 130) + objs->one;
+    for (int i = 0; i < 50; ++i) {
+        BigInt r = BigInt::random_below(bound, rng);
+        ASSERT(r < bound);
+    }
+
+    try {
+        BigInt::random_below(objs->negative_three, rng);
+        FAIL("negative bound was accepted");
+    } catch (std::invalid_argument &ex) {
+        // good
+    }
+}
+
+void test_stream_output(TestObjs *objs) {
+    auto fmt = [](const BigInt &val, std::ios_base::fmtflags flags, int width = 0) {
+        std::ostringstream oss;
+        oss.flags(flags);
+        oss.width(width);
+        oss << val;
+        return oss.str();
+    };
+
+    ASSERT(fmt(objs->zero, std::ios_base::dec) == "0");
+    ASSERT(fmt(objs->zero, std::ios_base::hex | std::ios_base::showbase) == "0");
+    ASSERT(fmt(objs->negative_three, std::ios_base::dec) == "-3");
+    ASSERT(fmt(objs->nine, std::ios_base::dec | std::ios_base::showpos) == "+9");
+
+    BigInt big({0xf2f2f2f2f2f2f2f2UL, 0xa0b0c0d0UL}, true);
+    ASSERT(fmt(big, std::ios_base::hex) == "-a0b0c0d0f2f2f2f2f2f2f2f2");
+    ASSERT(fmt(big, std::ios_base::hex | std::ios_base::uppercase | std::ios_base::showbase)
+           == "-0XA0B0C0D0F2F2F2F2F2F2F2F2");
+    ASSERT(fmt(big, std::ios_base::dec) == big.to_dec());
+
+    // octal digits straddle limb boundaries
+    ASSERT(fmt(objs->one << 64, std::ios_base::oct) == "2" + std::string(21, '0'));
+    ASSERT(fmt(BigInt(0777, false), std::ios_base::oct | std::ios_base::showbase) == "0777");
+
+    // field width and adjustment
+    ASSERT(fmt(objs->negative_three, std::ios_base::dec, 5) == "   -3");
+    ASSERT(fmt(objs->negative_three, std::ios_base::dec | std::ios_base::left, 5) == "-3   ");
+    ASSERT(fmt(objs->negative_three, std::ios_base::dec | std::ios_base::internal, 5) == "-   3");
+    ASSERT(fmt(big, std::ios_base::dec, 2) == big.to_dec());
+
+    // width applies to one insertion only, like for built-in integers
+    std::ostringstream oss;
+    oss << std::setw(4) << objs->nine << objs->nine;
+    ASSERT(oss.str() == "   99");
+
+    // nothing is written to a failed stream, which keeps its width
+    std::ostringstream failed;
+    failed.setstate(std::ios_base::failbit);
+    failed << std::setw(4) << objs->nine;
+    ASSERT(failed.str().empty() && failed.width() == 4);
+
+    // large values: output spans many internal blocks and matches to_dec/to_hex
+    std::mt19937_64 rng(35);
+    BigInt huge = BigInt::random_bits(20000, rng) + (objs->one << 20000);
+    ASSERT(fmt(huge, std::ios_base::dec) == huge.to_dec());
+    ASSERT(fmt(-huge, std::ios_base::hex) == (-huge).to_hex());
+
+    // chunk boundaries: 10^19 and 10^19 - 1
+    BigInt ten19(10000000000000000000UL, false);
+    ASSERT(ten19.to_dec() == "10000000000000000000");
+    ASSERT((ten19 * ten19).to_dec() == "1" + std::string(38, '0'));
+    ASSERT(fmt(ten19 * ten19 - objs->one, std::ios_base::dec) == std::string(38, '9'));
+}
+
+void test_copy_on_write(TestObjs *objs) {
+    // copies, assignment and sign-only changes share the limbs
+    BigInt big = objs->one << 1000;
+    const uint64_t *limbs = big.get_bit_vector().data();
+
+    BigInt copy(big);
+    ASSERT(copy.get_bit_vector().data() == limbs);
+    BigInt assigned;
+    assigned = big;
+    ASSERT(assigned.get_bit_vector().data() == limbs);
+    BigInt negated = -big;
+    ASSERT(negated.get_bit_vector().data() == limbs);
+    ASSERT((negated / objs->negative_one).get_bit_vector().data() == limbs);
+
+    // a modified value gets its own limbs; the others are unaffected
+    assigned = assigned + objs->one;
+    ASSERT(assigned.get_bit_vector().data() != limbs);
+    ASSERT(assigned == big + objs->one);
+    ASSERT(copy == big);
+    ASSERT(negated.is_negative() && !big.is_negative());
+    ASSERT(big.is_bit_set(1000) && !big.is_bit_set(0));
+
+    // division works on (shared) copies of its operands
+    ASSERT(big / objs->two == objs->one << 999);
+    ASSERT(big == objs->one << 1000);
+
+    // many threads may copy the same constant concurrently
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&big]() {
+            for (int i = 0; i < 10000; ++i) {
+                BigInt c = big;
+                BigInt n = -c;
+                (void) n;
+            }
+        });
+    }
+    for (std::thread &t : threads) {
+        t.join();
+    }
+    ASSERT(big == copy);
+}
+
+void test_mpn_kernels(TestObjs *) {
+    const uint64_t MAX = ~uint64_t(0);
+
+    // carries and borrows run through whole limbs
+    uint64_t a[3] = { MAX, MAX, 1 }, b[3] = { 1, 0, 0 }, r[3];
+    ASSERT(mpn_add_n(r, a, b, 3) == 0);
+    ASSERT(r[0] == 0 && r[1] == 0 && r[2] == 2);
+    ASSERT(mpn_sub_n(r, r, b, 3) == 0);
+    ASSERT(r[0] == MAX && r[1] == MAX && r[2] == 1);
+    ASSERT(mpn_sub_n(r, b, a, 3) == 1);
+    ASSERT(mpn_add_1(r, a, 2, 1) == 1);
+    ASSERT(mpn_sub_1(r, b, 3, 2) == 1 && r[2] == MAX);
+    ASSERT(mpn_add(r, a, 3, b, 1) == 0 && r[2] == 2);
+    ASSERT(mpn_sub(r, a, 3, a, 2) == 0 && r[0] == 0 && r[1] == 0 && r[2] == 1);
+
+    // single-limb multiply, multiply-accumulate and multiply-subtract
+    uint64_t x[2] = { MAX, MAX };
+    ASSERT(mpn_mul_1(r, x, 2, MAX) == MAX - 1);  // (2^128 - 1)(2^64 - 1)
+    ASSERT(r[0] == 1 && r[1] == MAX);
+    uint64_t acc[2] = { MAX, MAX };
+    ASSERT(mpn_addmul_1(acc, x, 2, MAX) == MAX);
+    ASSERT(acc[0] == 0 && acc[1] == MAX);
+    ASSERT(mpn_submul_1(acc, x, 2, MAX) == MAX);
+    ASSERT(acc[0] == MAX && acc[1] == MAX);
+
+    uint64_t p[4];
+    mpn_mul_basecase(p, x, 2, x, 2);  // (2^128 - 1)^2
+    ASSERT(p[0] == 1 && p[1] == 0 && p[2] == MAX - 1 && p[3] == MAX);
+
+    // single-limb division, in place
+    uint64_t n[2] = { 5, 7 };  // 7 * 2^64 + 5
+    ASSERT(mpn_mod_1(n, 2, 10) == (7 * 6 + 5) % 10);  // 2^64 = 6 (mod 10)
+    ASSERT(mpn_divrem_1(n, n, 2, 7) == 5);
+    ASSERT(n[1] == 1 && n[0] == 0);
+
+    // shifts report the bits shifted out, and work in place
+    uint64_t s[2] = { 0x8000000000000001UL, 0x3 };
+    ASSERT(mpn_lshift(s, s, 2, 63) == 1);
+    ASSERT(s[0] == 0x8000000000000000UL && s[1] == 0xC000000000000000UL);
+    ASSERT(mpn_rshift(s, s, 2, 63) == 0);
+    ASSERT(s[0] == 0x8000000000000001UL && s[1] == 0x1);
+
+    ASSERT(mpn_cmp(a, b, 3) > 0 && mpn_cmp(b, a, 3) < 0 && mpn_cmp(a, a, 3) == 0);
+    uint64_t z[3] = { 4, 0, 0 };
+    ASSERT(mpn_normalized_size(z, 3) == 1);
+    ASSERT(mpn_normalized_size(z + 1, 2) == 0);
+}
+
+void test_div_large(TestObjs *objs) {
+    std::mt19937_64 rng(37);
+
+    // random operands: q * b <= a < (q + 1) * b
+    for (int i = 0; i < 200; ++i) {
+        BigInt a = BigInt::random_bits(64 + rng() % 1500, rng);
+        BigInt b = BigInt::random_bits(1 + rng() % 700, rng) + objs->one;
+        BigInt q = a / b;
+        BigInt rem = a - q * b;
+        ASSERT(!rem.is_negative());
+        ASSERT(rem < b);
+    }
+
+    // divisors with a low top limb (large normalization shift) and
+    // with all-ones limbs exercise the quotient-estimate corrections
+    const uint64_t MAX = ~uint64_t(0);
+    BigInt dividends[] = {
+        BigInt({ 0, 0, 0x8000000000000000UL, MAX }),
+        BigInt({ MAX, MAX, MAX, MAX, MAX }),
+        BigInt({ 0, 0, 0, 0x7fffffffffffffffUL, 1 }),
+    };
+    BigInt divisors[] = {
+        BigInt({ 1, 0x8000000000000000UL }),
+        BigInt({ MAX, MAX }),
+        BigInt({ MAX, 1 }),
+        BigInt({ 0, 0, 1 }),
+        BigInt({ 3, 0x8000000000000000UL, 0x7fffffffffffffffUL }),
+    };
+    for (const BigInt &a : dividends) {
+        for (const BigInt &b : divisors) {
+            BigInt q = a / b;
+            BigInt rem = a - q * b;
+            ASSERT(!rem.is_negative() && rem < b);
+        }
+    }
+
+    // exact quotients and truncation toward zero
+    BigInt x = BigInt::random_bits(900, rng), y = BigInt::random_bits(400, rng) + objs->one;
+    ASSERT((x * y) / y == x);
+    ASSERT((-(x * y)) / y == -x);
+    ASSERT((x * y + y - objs->one) / -y == -x);
+    ASSERT(BigInt(7, true) / objs->two == BigInt(3, true));
+}
+
+void test_divrem_limb(TestObjs *objs) {
+    const uint64_t MAX = ~uint64_t(0);
+
+    // the reciprocal matches its definition
+    ASSERT(mpn_invert_limb(0x8000000000000000UL) == MAX);
+    ASSERT(mpn_invert_limb(MAX) == 1);
+
+    auto [q, r] = divrem(objs->large_positive, 10);
+    ASSERT(q == objs->large_positive / BigInt(10));
+    ASSERT(q * BigInt(10) + BigInt(r) == objs->large_positive);
+
+    // remainders carry the dividend's sign (as a magnitude)
+    auto [nq, nr] = divrem(BigInt(17, true), 5);
+    ASSERT(nq == BigInt(3, true) && nr == 2);
+    auto [zq, zr] = divrem(BigInt(3, true), 5);
+    ASSERT(zq == objs->zero && !zq.is_negative() && zr == 3);
+
+    // divisors of all sizes, including normalized ones and 1
+    std::mt19937_64 rng(38);
+    uint64_t divisors[] = { 1, 2, 3, 7, 10, 1000000007UL, 10000000000000000000UL,
+                            0x8000000000000000UL, MAX, MAX - 58 };
+    for (uint64_t d : divisors) {
+        for (int i = 0; i < 20; ++i) {
+            BigInt a = BigInt::random_bits(1 + rng() % 800, rng);
+            auto [qq, rr] = divrem(a, d);
+            ASSERT(rr < d);
+            ASSERT(qq * BigInt(d) + BigInt(rr) == a);
+            ASSERT(a / d == qq);
+            ASSERT(mpn_mod_1(a.get_bit_vector().data(), a.get_bit_vector().size(), d) == rr);
+        }
+    }
+
+    ASSERT(objs->nine / uint64_t(2) == BigInt(4));
+    ASSERT(objs->negative_nine / uint64_t(2) == BigInt(4, true));
+
+    try {
+        divrem(objs->nine, 0);
+        FAIL("division by zero was accepted");
+    } catch (std::invalid_argument &ex) {
+        // good
+    }
+}
+
+void test_mixed_word_ops(TestObjs *objs) {
+    auto big = [](int64_t v) { return BigInt(v < 0 ? 0 - uint64_t(v) : uint64_t(v), v < 0); };
+
+    // small values agree with built-in integer arithmetic, including
+    // the signs of truncated quotients and remainders
+    for (int64_t a = -20; a <= 20; ++a) {
+        for (int64_t b = -7; b <= 7; ++b) {
+            ASSERT(big(a) + b == big(a + b));
+            ASSERT(big(a) - b == big(a - b));
+            ASSERT(big(a) * b == big(a * b));
+            ASSERT((big(a) < b) == (a < b));
+            ASSERT((big(a) == b) == (a == b));
+            ASSERT((b >= big(a)) == (b >= a));
+            if (b != 0) {
+                ASSERT(big(a) / b == big(a / b));
+                ASSERT(big(a) % b == big(a % b));
+                ASSERT(big(a) % big(b) == big(a % b));
+            }
+        }
+    }
+
+    // carries, borrows and word-sized edge values
+    const uint64_t MAX = ~uint64_t(0);
+    ASSERT(objs->u64_max + 1 == objs->two_pow_64);
+    ASSERT(objs->two_pow_64 - 1 == objs->u64_max);
+    ASSERT(objs->two_pow_64 - objs->two_pow_64.get_bits(1) == objs->u64_max);
+    ASSERT(BigInt(5) - MAX == BigInt(MAX - 5, true));
+    ASSERT(objs->zero - uint64_t(0) == objs->zero && !(objs->zero - uint64_t(0)).is_negative());
+    ASSERT(objs->u64_max * MAX == objs->u64_max * objs->u64_max);
+    ASSERT(BigInt(1) * INT64_MIN == BigInt(0x8000000000000000UL, true));
+    ASSERT(BigInt(0x8000000000000000UL, true) == INT64_MIN);
+    ASSERT(BigInt(0x8000000000000000UL, true) - INT64_MIN == 0);
+    ASSERT(objs->two_pow_64 > MAX && objs->two_pow_64 > -1 && -objs->two_pow_64 < INT64_MIN);
+    ASSERT(objs->negative_three < 0U && 0 > objs->negative_three);
+
+    // word on the left
+    ASSERT(1 + objs->nine == BigInt(10));
+    ASSERT(2 * objs->negative_three == BigInt(6, true));
+    ASSERT(3 - objs->nine == BigInt(6, true));
+
+    // large values against their BigInt-operand equivalents
+    ASSERT(objs->large_positive % 1000000007 == objs->large_positive % BigInt(1000000007));
+    ASSERT((objs->large_positive / 1000000007) * 1000000007 + objs->large_positive % 1000000007
+           == objs->large_positive);
+    ASSERT(-objs->large_positive % 10 == -(objs->large_positive % 10));
+
+    try {
+        objs->nine % 0;
+        FAIL("remainder by zero was accepted");
+    } catch (std::invalid_argument &ex) {
+        // good
+    }
+}
+
+void test_addmul_submul(TestObjs *objs) {
+    std::mt19937_64 rng(40);
+    auto random_signed = [&rng](unsigned max_bits) {
+        BigInt v = BigInt::random_bits(rng() % max_bits, rng);
+        return (rng() & 1) ? -v : v;
+    };
+
+    // small (row by row) and large (Karatsuba-sized) products, all sign mixes
+    for (unsigned max_bits : { 300U, 5000U }) {
+        for (int i = 0; i < 40; ++i) {
+            BigInt acc = random_signed(max_bits), a = random_signed(max_bits), b = random_signed(max_bits);
+            BigInt expected_add = acc + a * b, expected_sub = acc - a * b;
+
+            BigInt x = acc;
+            addmul(x, a, b);
+            ASSERT(x == expected_add);
+            ASSERT(fma(a, b, acc) == expected_add);
+
+            BigInt y = acc;
+            submul(y, a, b);
+            ASSERT(y == expected_sub);
+        }
+    }
+
+    // results crossing zero, and exactly zero
+    BigInt acc = objs->nine;
+    submul(acc, objs->two, objs->nine);
+    ASSERT(acc == BigInt(9, true));
+    addmul(acc, objs->three, objs->three);
+    ASSERT(acc == objs->zero && !acc.is_negative());
+    submul(acc, objs->negative_three, objs->three);
+    ASSERT(acc == objs->nine);
+
+    // a borrow that runs through many limbs
+    BigInt big = objs->one << 640;
+    submul(big, objs->one, objs->one);
+    ASSERT(big == (objs->one << 640) - objs->one);
+
+    // operands may be the accumulator itself, or share its storage
+    BigInt self = objs->large_positive;
+    addmul(self, self, self);
+    ASSERT(self == objs->large_positive + objs->large_positive * objs->large_positive);
+    BigInt shared = self, before = self;
+    addmul(shared, self, objs->two);
+    ASSERT(shared == before * 3 && self == before);
+
+    // a dot product accumulates into one buffer
+    std::vector<BigInt> u, v;
+    BigInt naive, dot;
+    for (int i = 0; i < 50; ++i) {
+        u.push_back(random_signed(400));
+        v.push_back(random_signed(400));
+        naive = naive + u.back() * v.back();
+        addmul(dot, u.back(), v.back());
+    }
+    ASSERT(dot == naive);
+}
+
+void test_accumulator(TestObjs *objs) {
+  {
+    BigIntAccumulator acc;
+    ASSERT(acc.value() == objs->zero);
+  }
+
+  {
+    // mixed widths and signs, checked against a chain of operator+
+    std::mt19937_64 rng(41);
+    BigIntAccumulator acc;
+    BigInt expected;
+    for (int i = 0; i < 500; ++i) {
+      BigInt val = BigInt::random_bits(rng() % 700, rng);
+      if (rng() & 1) {
+        val = -val;
+      }
+      if (i % 3 == 0) {
+        acc -= val;
+        expected = expected - val;
+      } else {
+        acc += val;
+        expected = expected + val;
+      }
+    }
+    ASSERT(acc.value() == expected);
+
+    // reading does not disturb the sum
+    acc.add(objs->nine);
+    ASSERT(acc.value() == expected + objs->nine);
+
+    acc.clear();
+    ASSERT(acc.value() == objs->zero);
+    acc.sub(objs->three);
+    ASSERT(acc.value() == objs->negative_three);
+  }
+
+  {
+    // every limb overflows on every addition
+    BigInt all_ones = (objs->one << 256) - objs->one;
+    BigIntAccumulator acc;
+    for (int i = 0; i < 1000; ++i) {
+      acc.add(all_ones);
+    }
+    ASSERT(acc.value() == all_ones * 1000);
+
+    // positives and negatives cancelling exactly
+    for (int i = 0; i < 1000; ++i) {
+      acc.sub(all_ones);
+    }
+    ASSERT(acc.value() == objs->zero && !acc.value().is_negative());
+  }
+}
+
+void test_lazy_normalization(TestObjs *objs) {
+  // a value that shrank in place keeps its storage, and is still
+  // observed with the right length, sign and limbs
+  BigInt big = (objs->one << 1000) + objs->nine;
+  BigInt acc = big;
+  submul(acc, big, objs->one);
+  ASSERT(acc.is_zero() && !acc.is_negative());
+  ASSERT(acc == objs->zero);
+  ASSERT(BigIntView(acc).size() == 0);
+  ASSERT(acc.to_hex() == "0");
+
+  const uint64_t *storage = BigIntView(acc).data();
+  addmul(acc, objs->three, objs->negative_three);
+  ASSERT(acc == objs->negative_nine);
+  ASSERT(BigIntView(acc).data() == storage);  // no reallocation
+  ASSERT(acc.get_bits(1) == 0 && !acc.is_bit_set(64));
+
+  // get_bit_vector() trims the leading zero limbs
+  const std::vector<uint64_t> &vec = acc.get_bit_vector();
+  ASSERT(vec.size() == 1 && vec[0] == 9);
+
+  // copies share the untrimmed storage; modifying one copies only
+  // the significant limbs
+  BigInt acc2 = big;
+  submul(acc2, objs->one << 990, objs->one << 10);
+  ASSERT(acc2 == objs->nine);
+  BigInt shared = acc2;
+  addmul(shared, objs->one, objs->one);
+  ASSERT(shared == BigInt(10) && acc2 == objs->nine);
+  ASSERT(acc2.get_bit_vector().size() == 1);
+  ASSERT(shared.get_bit_vector().size() == 1);
+}
+
+void test_radix_conversion(TestObjs *objs) {
+  ASSERT(objs->zero.to_string(7) == "0");
+  ASSERT(objs->negative_nine.to_string(2) == "-1001");
+  ASSERT(objs->u64_max.to_string(36) == "3w5e11264sgsf");
+  ASSERT(objs->two_pow_64.to_string(8) == "2000000000000000000000");
+  ASSERT(objs->two_pow_64.to_string(32) == "g000000000000");
+
+  ASSERT(BigInt::from_string("ff", 16) == BigInt(255));
+  ASSERT(BigInt::from_string("-Z", 36) == BigInt(35, true));
+  ASSERT(BigInt::from_string("+10", 2) == objs->two);
+  ASSERT(BigInt::from_string("000123") == BigInt(123));
+  ASSERT(BigInt::from_string("-0").is_zero() && !BigInt::from_string("-0").is_negative());
+  ASSERT(BigInt::from_string("18446744073709551616") == objs->two_pow_64);
+  ASSERT(BigInt::from_string("3W5E11264SGSF", 36) == objs->u64_max);
+
+  // round trips in every base, from a limb or two up to divide and
+  // conquer sizes, and agreement with to_dec/to_hex
+  std::mt19937_64 rng(43);
+  for (unsigned bits : { 1U, 64U, 65U, 300U, 3000U, 20000U }) {
+    BigInt val = BigInt::random_bits(bits - 1, rng) + (objs->one << (bits - 1));
+    for (unsigned base = 2; base <= 36; ++base) {
+      std::string str = val.to_string(base);
+      ASSERT(BigInt::from_string(str, base) == val);
+      ASSERT(BigInt::from_string("-" + str, base) == -val);
+      ASSERT((-val).to_string(base) == "-" + str);
+    }
+    ASSERT(val.to_string(10) == val.to_dec());
+    ASSERT(val.to_string() == val.to_dec());
+    ASSERT(val.to_string(16) == val.to_hex());
+  }
+
+  // a power of ten sits exactly on the divide-and-conquer boundaries
+  BigInt ten_pow = objs->one;
+  for (int i = 0; i < 5000; ++i) {
+    ten_pow = ten_pow * 10;
+  }
+  std::string expected = "1" + std::string(5000, '0');
+  ASSERT(ten_pow.to_dec() == expected);
+  ASSERT(BigInt::from_string(expected) == ten_pow);
+  ASSERT((ten_pow - objs->one).to_dec() == std::string(5000, '9'));
+  ASSERT(BigInt::from_string(std::string(5000, '9')) == ten_pow - objs->one);
+
+  // the shared power cache is grown from several threads at once
+  BigInt big = BigInt::random_bits(40000, rng);
+  std::string big_str = big.to_string(7);
+  std::vector<std::thread> threads;
+  std::atomic<int> failures(0);
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&big, &big_str, &failures]() {
+      if (big.to_string(7) != big_str || BigInt::from_string(big_str, 7) != big) {
+        ++failures;
+      }
+    });
+  }
+  for (std::thread &t : threads) {
+    t.join();
+  }
+  ASSERT(failures == 0);
+
+  const char *bad[] = { "", "-", "+", "12a", "1 2", "--1", "0x10" };
+  for (const char *str : bad) {
+    try {
+      BigInt::from_string(str);
+      FAIL("invalid string was accepted");
+    } catch (std::invalid_argument &ex) {
+      // good
+    }
+  }
+  try {
+    BigInt::from_string("2", 2);
+    FAIL("digit out of range for the base was accepted");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+  for (unsigned base : { 0U, 1U, 37U }) {
+    try {
+      objs->nine.to_string(base);
+      FAIL("invalid base was accepted");
+    } catch (std::invalid_argument &ex) {
+      // good
+    }
+  }
+}
+
+void test_double_conversion(TestObjs *objs) {
+  ASSERT(objs->zero.bit_length() == 0);
+  ASSERT(objs->one.bit_length() == 1);
+  ASSERT(objs->negative_nine.bit_length() == 4);
+  ASSERT(objs->u64_max.bit_length() == 64);
+  ASSERT(objs->two_pow_64.bit_length() == 65);
+
+  ASSERT(objs->zero.to_double() == 0.0);
+  ASSERT(objs->negative_nine.to_double() == -9.0);
+  ASSERT(objs->two_pow_64.to_double() == 18446744073709551616.0);
+  ASSERT(objs->u64_max.to_double() == 18446744073709551616.0);  // rounds up
+
+  // ties go to the even mantissa
+  BigInt p53 = objs->one << 53;
+  ASSERT((p53 + objs->one).to_double() == 9007199254740992.0);
+  ASSERT((p53 + objs->three).to_double() == 9007199254740996.0);
+  ASSERT((p53 + BigInt(5)).to_double() == 9007199254740996.0);
+
+  // a tie in the top bits broken by a bit far below them
+  BigInt tie = (objs->one << 500) + (objs->one << 447);
+  ASSERT(tie.to_double() == std::ldexp(1.0, 500));
+  ASSERT((tie + objs->one).to_double() == std::ldexp(1.0, 500) + std::ldexp(1.0, 448));
+  ASSERT((-(tie + objs->one)).to_double() == -(std::ldexp(1.0, 500) + std::ldexp(1.0, 448)));
+
+  // overflow to infinity, including by rounding up
+  ASSERT((objs->one << 1024).to_double() == std::numeric_limits<double>::infinity());
+  ASSERT((-(objs->one << 5000)).to_double() == -std::numeric_limits<double>::infinity());
+  BigInt max_double = ((objs->one << 53) - objs->one) << 971;
+  ASSERT(max_double.to_double() == std::numeric_limits<double>::max());
+  ASSERT((max_double + (objs->one << 969)).to_double() == std::numeric_limits<double>::max());
+  ASSERT((max_double + (objs->one << 970)).to_double() == std::numeric_limits<double>::infinity());
+
+  // long double keeps more bits where it has them
+  if (std::numeric_limits<long double>::digits == 64) {
+    ASSERT(objs->u64_max.to_long_double() == 18446744073709551615.0L);
+    ASSERT((objs->two_pow_64 + objs->one).to_long_double() == 18446744073709551616.0L);
+    ASSERT((objs->two_pow_64 + objs->three).to_long_double() == 18446744073709551620.0L);
+    ASSERT((objs->one << 2000).to_long_double() == std::ldexp(1.0L, 2000));
+  }
+
+  ASSERT(BigInt::from_double(0.0).is_zero());
+  ASSERT(BigInt::from_double(0.9).is_zero());
+  ASSERT(BigInt::from_double(-0.9).is_zero() && !BigInt::from_double(-0.9).is_negative());
+  ASSERT(BigInt::from_double(-2.5) == BigInt(2, true));
+  ASSERT(BigInt::from_double(18446744073709551616.0) == objs->two_pow_64);
+  ASSERT(BigInt::from_double(std::ldexp(3.0, 700)) == (objs->three << 700));
+  ASSERT(BigInt::from_double(1e300).to_double() == 1e300);
+  ASSERT(BigInt::from_double(-123456789.75) == BigInt(123456789, true));
+  ASSERT(BigInt::from_long_double(-12345678901234567890.0L) == BigInt(12345678901234567890ULL, true));
+  for (double bad : { std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN() }) {
+    try {
+      BigInt::from_double(bad);
+      FAIL("non-finite double was accepted");
+    } catch (std::invalid_argument &ex) {
+      // good
+    }
+  }
+
+  // random round trips: every double is an exact conversion
+  std::mt19937_64 rng(44);
+  for (int i = 0; i < 200; ++i) {
+    BigInt val = BigInt::random_bits(1 + rng() % 53, rng) << (rng() % 900);
+    ASSERT(BigInt::from_double(val.to_double()) == val);
+  }
+
+  ASSERT(objs->zero.log2_approx() == -std::numeric_limits<double>::infinity());
+  ASSERT(objs->one.log2_approx() == 0.0);
+  ASSERT((objs->one << 1000).log2_approx() == 1000.0);
+  ASSERT(std::fabs(objs->three.log2_approx() - std::log2(3.0)) < 1e-12);
+  BigInt ten_pow = BigInt::from_string("1" + std::string(3000, '0'));
+  ASSERT(std::fabs(ten_pow.log2_approx() - 3000 * std::log2(10.0)) < 1e-9);
+  ASSERT(std::fabs(objs->negative_nine.log2_approx() - std::log2(9.0)) < 1e-12);
+}
+
+void test_bit_queries(TestObjs *objs) {
+  ASSERT(objs->zero.countr_zero() == 0);
+  ASSERT(objs->zero.popcount() == 0);
+  ASSERT(objs->nine.countr_zero() == 0);
+  ASSERT(objs->two.countr_zero() == 1);
+  ASSERT(objs->two_pow_64.countr_zero() == 64);
+  ASSERT(objs->u64_max.popcount() == 64);
+  ASSERT(objs->negative_nine.popcount() == 2);
+  ASSERT(((objs->one << 300) + (objs->one << 200)).countr_zero() == 200);
+
+  // extract_bits, within and across limbs and past the top
+  BigInt val = BigInt({ 0x0123456789abcdefULL, 0xfedcba9876543210ULL });
+  ASSERT(val.extract_bits(0, 64) == 0x0123456789abcdefULL);
+  ASSERT(val.extract_bits(4, 8) == 0xde);
+  ASSERT(val.extract_bits(60, 8) == 0x00);
+  ASSERT(val.extract_bits(56, 16) == 0x1001);
+  ASSERT(val.extract_bits(32, 64) == 0x7654321001234567ULL);
+  ASSERT(val.extract_bits(120, 16) == 0xfe);
+  ASSERT(val.extract_bits(500, 64) == 0);
+  ASSERT(val.extract_bits(3, 0) == 0);
+  try {
+    val.extract_bits(0, 65);
+    FAIL("extracting more than 64 bits was accepted");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+
+  // set_bit and clear_bit grow, shrink and keep the sign
+  BigInt x;
+  x.set_bit(200);
+  ASSERT(x == (objs->one << 200) && x.bit_length() == 201);
+  x.set_bit(3);
+  ASSERT(x.popcount() == 2 && x.countr_zero() == 3);
+  x.clear_bit(200);
+  ASSERT(x == BigInt(8) && x.bit_length() == 4);
+  ASSERT(x.get_bit_vector().size() == 1);
+  x.clear_bit(1000);
+  ASSERT(x == BigInt(8));
+
+  BigInt neg = objs->negative_nine;
+  neg.clear_bit(3);
+  ASSERT(neg == BigInt(1, true));
+  neg.clear_bit(0);
+  ASSERT(neg.is_zero() && !neg.is_negative());
+  neg = objs->negative_nine;
+  neg.set_bit(1);
+  ASSERT(neg == BigInt(11, true));
+
+  // setting a bit detaches shared storage; clearing an unset bit doesn't touch it
+  BigInt a = objs->large_positive, b = a;
+  b.set_bit(0);
+  b.clear_bit(0);
+  ASSERT(a == objs->large_positive);
+  b.set_bit(5000);
+  ASSERT(a == objs->large_positive && b.bit_length() == 5001);
+
+  // agreement with is_bit_set and shifts on random values
+  std::mt19937_64 rng(45);
+  for (int i = 0; i < 50; ++i) {
+    BigInt r = BigInt::random_bits(1 + rng() % 1000, rng);
+    size_t set = 0;
+    for (unsigned k = 0; k < r.bit_length(); ++k) {
+      set += r.is_bit_set(k);
+    }
+    ASSERT(r.popcount() == set);
+    if (!r.is_zero()) {
+      size_t tz = r.countr_zero();
+      ASSERT(r.is_bit_set(tz) && ((r >> tz) << tz) == r);
+    }
+    size_t pos = rng() % 1100;
+    unsigned width = 1 + rng() % 64;
+    BigInt field = (r >> pos) - (((r >> pos) >> width) << width);
+    ASSERT(BigInt(r.extract_bits(pos, width)) == field);
+  }
+}
+
+void test_gcd(TestObjs *objs) {
+  ASSERT(gcd(objs->zero, objs->zero).is_zero());
+  ASSERT(gcd(objs->zero, objs->negative_nine) == objs->nine);
+  ASSERT(gcd(objs->negative_nine, objs->zero) == objs->nine);
+  ASSERT(gcd(objs->nine, objs->three) == objs->three);
+  ASSERT(gcd(objs->negative_nine, objs->negative_three) == objs->three);
+  ASSERT(gcd(BigInt(48), BigInt(180)) == BigInt(12));
+  ASSERT(gcd(objs->one << 300, objs->one << 200) == (objs->one << 200));
+  ASSERT(gcd(objs->u64_max, objs->two_pow_64) == objs->one);
+
+  // gcd(g * x, g * y) = g * gcd(x, y), for values of very different
+  // sizes too (which take the division shortcut)
+  std::mt19937_64 rng(46);
+  for (int i = 0; i < 30; ++i) {
+    BigInt g = BigInt::random_bits(1 + rng() % 300, rng) + objs->one;
+    BigInt x = BigInt::random_bits(1 + rng() % 2000, rng) + objs->one;
+    BigInt y = BigInt::random_bits(1 + rng() % 200, rng) + objs->one;
+    BigInt expected = gcd(x, y) * g;
+    ASSERT(gcd(g * x, g * y) == expected);
+    ASSERT(gcd(-(g * y), g * x) == expected);
+    ASSERT((x % gcd(x, y)).is_zero() && (y % gcd(x, y)).is_zero());
+  }
+
+  // consecutive Fibonacci numbers are coprime (the slowest case for Euclid)
+  BigInt f0 = objs->zero, f1 = objs->one;
+  for (int i = 0; i < 1000; ++i) {
+    BigInt f2 = f0 + f1;
+    f0 = f1;
+    f1 = f2;
+  }
+  ASSERT(gcd(f0, f1) == objs->one);
+  ASSERT(gcd(f0 * objs->nine, f1 * objs->three) == objs->three);
+}
+
+void test_rational(TestObjs *objs) {
+  BigRational zero;
+  ASSERT(zero.is_zero() && zero.is_canonical() && zero.to_dec() == "0");
+
+  // construction moves the sign up and defers reduction
+  BigRational half(BigInt(2, true), BigInt(4, true));
+  ASSERT(!half.is_canonical());
+  ASSERT(half.numerator() == objs->two && half.denominator() == BigInt(4));
+  ASSERT(half.to_dec() == "1/2");
+  half.canonicalize();
+  ASSERT(half.is_canonical() && half.numerator() == objs->one && half.denominator() == objs->two);
+  BigRational neg(objs->three, BigInt(6, true));
+  ASSERT(neg.is_negative() && neg.denominator() == BigInt(6));
+  ASSERT(BigRational(objs->zero, objs->nine).denominator() == objs->one);
+  ASSERT(BigRational(objs->nine, objs->one).is_canonical());
+  try {
+    BigRational bad(objs->one, objs->zero);
+    FAIL("zero denominator was accepted");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+
+  // canonical operands give canonical results
+  BigRational sixth(objs->one, BigInt(6)), third(objs->one, objs->three);
+  sixth.canonicalize();
+  third.canonicalize();
+  BigRational sum = sixth + third;
+  ASSERT(sum.is_canonical() && sum.numerator() == objs->one && sum.denominator() == objs->two);
+  BigRational prod = BigRational(BigInt(4), objs->nine).canonicalize() * BigRational(objs->three, objs->two).canonicalize();
+  ASSERT(prod.is_canonical() && prod.to_dec() == "2/3" && prod.denominator() == objs->three);
+  ASSERT((sixth - third).to_dec() == "-1/6");
+  ASSERT((sixth / third).to_dec() == "1/2");
+  ASSERT((third / -sixth).to_dec() == "-2");
+  ASSERT((sixth / -third).is_canonical() && (sixth / -third).denominator() == objs->two);
+
+  // unreduced operands are cross-multiplied without reducing
+  BigRational lazy = BigRational(objs->two, BigInt(4)) + BigRational(objs->two, BigInt(4));
+  ASSERT(!lazy.is_canonical() && lazy == BigRational(objs->one));
+  ASSERT(lazy.canonicalize().denominator() == objs->one);
+
+  try {
+    sixth / zero;
+    FAIL("division by zero was accepted");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+
+  // comparison
+  ASSERT(sixth < third && third > sixth && -third < -sixth);
+  ASSERT(BigRational(objs->two, BigInt(6)) == third);
+  ASSERT(BigRational(objs->negative_one, objs->two) < zero);
+  ASSERT(sixth != third && sixth <= sixth && third >= sixth);
+
+  // H_20, summed with and without keeping canonical form
+  BigRational h, h_lazy;
+  for (uint64_t k = 1; k <= 20; ++k) {
+    BigRational term(objs->one, BigInt(k));
+    h_lazy = h_lazy + term;
+    h = h + term.canonicalize();
+    ASSERT(h.is_canonical());
+  }
+  ASSERT(h.to_dec() == "55835135/15519504");
+  ASSERT(h_lazy == h && h_lazy.to_dec() == h.to_dec());
+
+  // the canonical shortcuts agree with reducing afterwards
+  std::mt19937_64 rng(46);
+  for (int i = 0; i < 50; ++i) {
+    BigInt common = BigInt::random_bits(1 + rng() % 100, rng) + objs->one;
+    BigRational a(BigInt::random_bits(1 + rng() % 200, rng) * common, (BigInt::random_bits(1 + rng() % 200, rng) + objs->one) * common);
+    BigRational b(-BigInt::random_bits(1 + rng() % 200, rng), (BigInt::random_bits(1 + rng() % 200, rng) + objs->one) * common);
+    BigRational ca = a, cb = b;
+    ca.canonicalize();
+    cb.canonicalize();
+    BigRational s = ca + cb, p = ca * cb, s_lazy = a + b, p_lazy = a * b;
+    ASSERT(s.is_canonical() && p.is_canonical());
+    ASSERT(s_lazy.canonicalize().numerator() == s.numerator() && s_lazy.denominator() == s.denominator());
+    ASSERT(p_lazy.canonicalize().numerator() == p.numerator() && p_lazy.denominator() == p.denominator());
+  }
+
+  ASSERT(third.to_double() == 1.0 / 3.0);
+  ASSERT((-sixth).to_double() == -1.0 / 6.0);
+  ASSERT(BigRational(objs->one << 2000, (objs->one << 1999) + objs->one).to_double() == 2.0);
+  ASSERT(BigRational(objs->one, objs->one << 1074).to_double() == std::ldexp(1.0, -1074));
+}
+
+void test_bigfloat(TestObjs *objs) {
+  const RoundingMode modes[] = { RoundingMode::NEAREST_EVEN, RoundingMode::TOWARD_ZERO,
+                                 RoundingMode::TOWARD_POSITIVE, RoundingMode::TOWARD_NEGATIVE };
+
+  // values are normalized to an odd mantissa
+  BigFloat twelve(BigInt(12));
+  ASSERT(twelve.mantissa() == objs->three && twelve.exponent() == 2);
+  ASSERT(BigFloat().is_zero() && BigFloat(0.0).is_zero());
+  ASSERT(BigFloat(-0.375).mantissa() == objs->negative_three && BigFloat(-0.375).exponent() == -3);
+
+  // rounding 0b10110 (22) to 3 bits, and ties (0b1010 = 10, 0b1110 = 14)
+  ASSERT(BigFloat(BigInt(22), 3, RoundingMode::NEAREST_EVEN).to_double() == 24.0);
+  ASSERT(BigFloat(BigInt(22), 3, RoundingMode::TOWARD_ZERO).to_double() == 20.0);
+  ASSERT(BigFloat(BigInt(22), 3, RoundingMode::TOWARD_POSITIVE).to_double() == 24.0);
+  ASSERT(BigFloat(-BigInt(22), 3, RoundingMode::TOWARD_POSITIVE).to_double() == -20.0);
+  ASSERT(BigFloat(-BigInt(22), 3, RoundingMode::TOWARD_NEGATIVE).to_double() == -24.0);
+  ASSERT(BigFloat(BigInt(10), 2).to_double() == 8.0);
+  ASSERT(BigFloat(BigInt(14), 2).to_double() == 16.0);
+  BigFloat wide(objs->u64_max, 64);
+  wide.set_precision(8);
+  ASSERT(wide.mantissa() == objs->one && wide.exponent() == 64);
+
+  // at 53 bits, rounding to nearest agrees with IEEE double arithmetic
+  std::mt19937_64 rng(47);
+  std::uniform_real_distribution<double> dist(-1e6, 1e6);
+  for (int i = 0; i < 200; ++i) {
+    double x = dist(rng), y = std::ldexp(dist(rng), static_cast<int>(rng() % 200) - 100);
+    BigFloat a(x, 53), b(y, 53);
+    ASSERT((a + b).to_double() == x + y);
+    ASSERT((a - b).to_double() == x - y);
+    ASSERT((a * b).to_double() == x * y);
+    ASSERT((a / b).to_double() == x / y);
+    ASSERT(BigFloat::sqrt(BigFloat(std::fabs(x), 53), 53, RoundingMode::NEAREST_EVEN).to_double() == std::sqrt(std::fabs(x)));
+    ASSERT((a < b) == (x < y) && (a == b) == (x == y) && (a >= b) == (x >= y));
+
+    // directed modes bracket the exact result, one unit apart if inexact
+    BigFloat down = BigFloat::div(a, b, 53, RoundingMode::TOWARD_NEGATIVE);
+    BigFloat up = BigFloat::div(a, b, 53, RoundingMode::TOWARD_POSITIVE);
+    BigFloat trunc = BigFloat::div(a, b, 53, RoundingMode::TOWARD_ZERO);
+    ASSERT(down < up && std::nextafter(down.to_double(), INFINITY) == up.to_double());
+    ASSERT(trunc == ((x / y < 0) ? up : down));
+
+    // the default %e formatting round trips through printf's
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.16e", x);
+    ASSERT(a.to_string(17) == buf);
+  }
+
+  // a tiny addend only decides the direction of rounding
+  BigFloat one(objs->one, 64), tiny = BigFloat::from_parts(objs->one, -1000000);
+  for (RoundingMode mode : modes) {
+    BigFloat sum = BigFloat::add(one, tiny, 64, mode), diff = BigFloat::sub(one, tiny, 64, mode);
+    bool up = (mode == RoundingMode::TOWARD_POSITIVE);
+    bool down = (mode == RoundingMode::TOWARD_NEGATIVE || mode == RoundingMode::TOWARD_ZERO);
+    ASSERT(sum == (up ? BigFloat::from_parts((objs->one << 63) + objs->one, -63) : one));
+    ASSERT(diff == (down ? BigFloat::from_parts((objs->one << 64) - objs->one, -64) : one));
+  }
+  ASSERT((one + tiny - one).is_zero() && !(one + tiny > one));
+
+  // sqrt(2) at 2000 bits, truncated, is the integer square root
+  BigFloat root2 = BigFloat::sqrt(BigFloat(objs->two), 2000, RoundingMode::TOWARD_ZERO);
+  ASSERT(root2 == BigFloat::from_parts(isqrt(objs->one << 3999), -1999, 2000));
+  ASSERT(root2.precision() == 2000 && root2.mantissa().bit_length() <= 2000);
+  ASSERT(root2 * root2 < BigFloat(objs->two) && BigFloat(objs->nine, 10).sqrt().to_double() == 3.0);
+  ASSERT(BigFloat::sqrt(BigFloat(objs->two), 200, RoundingMode::NEAREST_EVEN).to_string(30) == "1.41421356237309504880168872421e+00");
+
+  // subnormal results round once, at the subnormal's own precision
+  double denorm_min = std::ldexp(1.0, -1074);
+  ASSERT(BigFloat::from_parts(BigInt((1ULL << 59) + 1), -1134).to_double() == denorm_min);
+  ASSERT(BigFloat::from_parts(objs->one, -1075).to_double() == 0.0);
+  ASSERT(BigFloat::from_parts(-objs->three, -1076).to_double() == -denorm_min);
+  ASSERT(BigFloat::from_parts(objs->three, -1075).to_double() == 2 * denorm_min);
+  ASSERT(BigFloat::from_parts(BigInt(13), -1076).to_double() == 3 * denorm_min);
+  ASSERT(BigFloat::from_parts((objs->one << 80) - objs->one, -1100).to_double() == std::ldexp(1.0, -1020));
+  for (double d : { denorm_min, 1e-310, -1e-315, 2.2250738585072014e-308 }) {
+    ASSERT(BigFloat(d).to_double() == d);
+  }
+
+  // exact operations at high precision
+  BigFloat third = BigFloat(objs->one, 1000) / BigFloat(objs->three, 1000);
+  ASSERT(third.to_string(20) == "3.3333333333333333333e-01");
+  ASSERT((third * BigFloat(objs->three)).to_string(10) == "1.000000000e+00");
+  BigFloat big(BigInt::from_string("123456789012345678901234567890"), 200);
+  ASSERT(big * big == BigFloat(BigInt::from_string("15241578753238836750495351562536198787501905199875019052100"), 200));
+  ASSERT(big.to_string(5) == "1.2346e+29" && (-big).to_string(1) == "-1e+29");
+  ASSERT(BigFloat(9.9999).to_string(3) == "1.00e+01" && BigFloat(1e-5).to_string(2) == "1.0e-05");
+  ASSERT(BigFloat().to_string() == "0" && BigFloat(1.5, 53).to_string() == "1.5000000000000000e+00");
+
+  try {
+    BigFloat(objs->one) / BigFloat();
+    FAIL("division by zero was accepted");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+  try {
+    BigFloat(objs->negative_one).sqrt();
+    FAIL("square root of a negative value was accepted");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+  try {
+    BigFloat(objs->one, 0);
+    FAIL("zero precision was accepted");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+  try {
+    // 2^(2^40) can't be expanded by a shift of unsigned count
+    BigFloat::from_parts(objs->one, int64_t(1) << 40).to_string();
+    FAIL("exponent shift was truncated");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+}
+
+void test_modint(TestObjs *objs) {
+  std::mt19937_64 rng(48);
+
+  // runtime modulus: a chain of operations agrees with reducing BigInt results
+  BigInt p = next_prime(BigInt::random_bits(200, rng));
+  auto ctx = ModInt::context(p);
+  BigInt x = BigInt::random_bits(300, rng), y = BigInt::random_bits(150, rng);
+  ModInt a(ctx, x), b(ctx, y), acc(ctx, objs->one);
+  BigInt expected = objs->one;
+  for (int i = 0; i < 100; ++i) {
+    acc *= a;
+    acc += b;
+    acc -= ModInt(ctx, BigInt(uint64_t(i)));
+    expected = (expected * x + y + p - BigInt(uint64_t(i))) % p;
+  }
+  ASSERT(acc.value() == expected && acc.modulus() == p);
+  ASSERT((a * b).value() == (x * y) % p);
+  ASSERT((a + b).value() == (x + y) % p);
+  ASSERT((b - a).value() == (y + p - x % p) % p);
+  ASSERT((-a + a).is_zero() && ModInt(ctx, -x) == -a);
+  ASSERT(a.pow(p - objs->one) == ModInt(ctx, objs->one));
+  ASSERT(a.pow(objs->three) == a * a * a && a.pow(objs->three) != a);
+
+  // separate contexts for the same modulus mix; different moduli don't
+  ASSERT(ModInt(ModInt::context(p), x) == a);
+  try {
+    a + ModInt(ModInt::context(p + objs->two), x);
+    FAIL("operands with different moduli were accepted");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+  try {
+    ModInt(nullptr, x);
+    FAIL("null context was accepted");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+
+  // compile-time moduli: 2^61 - 1, and the largest 64-bit prime
+  typedef StaticModInt<(1ULL << 61) - 1> M61;
+  typedef StaticModInt<18446744073709551557ULL> M64;
+  static_assert(M64::modulus() == 18446744073709551557ULL, "modulus is a constant");
+  for (int i = 0; i < 200; ++i) {
+    uint64_t u = rng(), v = rng();
+    unsigned __int128 m61 = M61::modulus(), m64 = M64::modulus();
+    ASSERT((M61(u) * M61(v)).value() == (uint64_t) ((unsigned __int128) (u % m61) * (v % m61) % m61));
+    ASSERT((M61(u) + M61(v)).value() == (uint64_t) (((u % m61) + (v % m61)) % m61));
+    ASSERT((M64(u) * M64(v)).value() == (uint64_t) ((unsigned __int128) (u % m64) * (v % m64) % m64));
+    ASSERT((M64(u) + M64(v)).value() == (uint64_t) (((unsigned __int128) (u % m64) + (v % m64)) % m64));
+    ASSERT((M64(u) - M64(v)).value() == (uint64_t) (((unsigned __int128) (u % m64) + m64 - (v % m64)) % m64));
+    ASSERT(M64(u).pow(M64::modulus() - 1) == M64(1) || M64(u).is_zero());
+  }
+  ASSERT(M61(BigInt::from_string("123456789012345678901234567890")).value() == (BigInt::from_string("123456789012345678901234567890") % M61::modulus()).get_bits(0));
+  ASSERT(M61(objs->negative_one).value() == M61::modulus() - 1);
+  ASSERT(M61(objs->negative_one) == -M61(1) && M61().is_zero() && (-M61()).is_zero());
+  ASSERT(StaticModInt<1>(12345).is_zero());
+}
+
+void test_rns(TestObjs *objs) {
+  std::mt19937_64 rng(49);
+
+  auto basis = RNSInt::context(2000);
+  ASSERT(basis->size() == 33 && basis->capacity_bits() == 2000);
+  ASSERT(basis->modulus() > (objs->one << 2001));
+  for (size_t i = 0; i < basis->size(); ++i) {
+    ASSERT(basis->prime(i) < (1ULL << 62) && basis->prime(i) > (1ULL << 61));
+    ASSERT(i == 0 || basis->prime(i) < basis->prime(i - 1));
+    ASSERT(is_probable_prime(BigInt(basis->prime(i))));
+  }
+
+  // conversion round trips, including negative values and zero
+  ASSERT(RNSInt(basis, objs->zero).is_zero() && RNSInt(basis, objs->zero).to_bigint().is_zero());
+  ASSERT(RNSInt(basis, objs->negative_nine).to_bigint() == objs->negative_nine);
+  ASSERT(RNSInt(basis, objs->negative_nine).residue(0) == basis->prime(0) - 9);
+  BigInt big = BigInt::random_bits(1999, rng);
+  ASSERT(RNSInt(basis, big).to_bigint() == big && RNSInt(basis, -big).to_bigint() == -big);
+
+  // a chain of products and sums agrees with BigInt arithmetic
+  BigInt expected = objs->one;
+  RNSInt acc(basis, objs->one);
+  for (int i = 0; i < 9; ++i) {
+    BigInt x = BigInt::random_bits(200, rng);
+    if (i % 3 == 0) {
+      x = -x;
+    }
+    expected = expected * x + objs->three;
+    acc *= RNSInt(basis, x);
+    acc += RNSInt(basis, objs->three);
+  }
+  ASSERT(acc.to_bigint() == expected);
+  RNSInt a(basis, big >> 1000), b(basis, -(big >> 1200));
+  ASSERT((a * b).to_bigint() == (big >> 1000) * -(big >> 1200));
+  ASSERT((a - b).to_bigint() == (big >> 1000) + (big >> 1200));
+  ASSERT((b - a).to_bigint() == -(big >> 1200) - (big >> 1000));
+  ASSERT((a + b).to_bigint() == (big >> 1000) - (big >> 1200));
+  ASSERT((-a).to_bigint() == -(big >> 1000) && (a + -a).is_zero());
+  ASSERT(a * b == b * a && a != b);
+
+  // values are kept modulo M
+  ASSERT(RNSInt(basis, basis->modulus() + objs->two).to_bigint() == objs->two);
+
+  // bases with the same number of primes mix; others don't
+  ASSERT(RNSInt(RNSInt::context(1990), big) == RNSInt(basis, big));
+  try {
+    a + RNSInt(RNSInt::context(100), big);
+    FAIL("operands with different bases were accepted");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+  try {
+    RNSInt(nullptr, big);
+    FAIL("null basis was accepted");
+  } catch (std::invalid_argument &ex) {
+    // good
+  }
+
+  // a basis large enough to split the residue loops across threads
+  auto wide = RNSInt::context(61 * RNSInt::PARALLEL_THRESHOLD * 2);
+  BigInt x = BigInt::random_bits(5000, rng), y = -BigInt::random_bits(5000, rng);
+  RNSInt wx(wide, x), wy(wide, y);
+  unsigned saved = BigInt::get_max_threads();
+  BigInt::set_max_threads(4);
+  RNSInt prod = wx * wy, sum = wx + wy, diff = wx - wy;
+  BigInt::set_max_threads(saved);
+  for (size_t i = 0; i < wide->size(); i += 997) {
+    uint64_t p = wide->prime(i);
+    uint64_t xr = (x % p).get_bits(0), yr = (p - (-y % p).get_bits(0)) % p;
+    ASSERT(prod.residue(i) == (uint64_t) ((unsigned __int128) xr * yr % p));
+    ASSERT(sum.residue(i) == (xr + yr) % p);
+    ASSERT(diff.residue(i) == (xr + p - yr) % p);
+  }
+}
@@ -0,0 +1,144 @@
+// Times BigInt's algorithm tiers against each other on this machine
+// and prints a bigint_thresholds.h header with their crossover points.
+// Built with -DBIGINT_TUNE (so the thresholds can be changed between
+// measurements) and run by "make tune"; progress goes to stderr.
+//
+// Division has a single tier (Knuth's Algorithm D, in mpn_tdiv_qr),
+// so there is nothing to tune for it.
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "bigint.h"
+
+// Median time per call of f, in seconds, over several runs that are
+// each long enough (about 2 ms) for the clock to resolve
+static double time_op(const std::function<void()> &f) {
+    typedef std::chrono::steady_clock Clock;
+    auto run = [&f](size_t reps) {
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < reps; ++i) {
+            f();
+        }
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+
+    size_t reps = 1;
+    while (run(reps) < 0.002) {
+        reps *= 2;
+    }
+    std::vector<double> times;
+    for (int i = 0; i < 5; ++i) {
+        times.push_back(run(reps) / reps);
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+// A random value of exactly n limbs
+static BigInt random_limbs(size_t n, std::mt19937_64 &rng) {
+    BigInt val = BigInt::random_bits(static_cast<unsigned>(64 * n), rng);
+    val.set_bit(64 * n - 1);
+    return val;
+}
+
+// Smallest size from which `fast` (the tier above the threshold) beats
+// `slow` at two sizes in a row, so one noisy measurement doesn't
+// decide; `fallback` if it never does within the sizes tried
+static size_t crossover(const char *name, size_t &threshold, const std::vector<size_t> &sizes,
+                        const std::function<std::function<void()>(size_t)> &make_op,
+                        size_t fallback) {
+    size_t saved = threshold, first_win = 0;
+    int wins = 0;
+    for (size_t n : sizes) {
+        std::function<void()> op = make_op(n);
+        threshold = n + 1;
+        double below = time_op(op);
+        threshold = n;
+        double above = time_op(op);
+        std::cerr << name << ": size " << n << ": " << below * 1e6 << " us below, "
+                  << above * 1e6 << " us above" << std::endl;
+
+        if (above < below) {
+            if (wins++ == 0) {
+                first_win = n;
+            }
+            if (wins == 2) {
+                threshold = saved;
+                return first_win;
+            }
+        } else {
+            wins = 0;
+        }
+    }
+    threshold = saved;
+    return fallback;
+}
+
+int main() {
+    std::mt19937_64 rng(2024);
+
+    // Schoolbook vs. one level of Karatsuba (with schoolbook below)
+    std::vector<size_t> mul_sizes;
+    for (size_t n = 8; n <= 160; n += 4) {
+        mul_sizes.push_back(n);
+    }
+    size_t karatsuba = crossover("karatsuba", BigInt::KARATSUBA_THRESHOLD, mul_sizes,
+        [&rng](size_t n) -> std::function<void()> {
+            BigInt a = random_limbs(n, rng), b = random_limbs(n, rng);
+            return [a, b]() { BigInt p = a * b; };
+        }, 160);
+    BigInt::KARATSUBA_THRESHOLD = karatsuba;
+
+    // Limb-at-a-time vs. divide-and-conquer radix conversion (with the
+    // radix power cache already filled), in each direction on its own.
+    // Formatting is sized in limbs of the value; parsing in chunks of
+    // 19 decimal digits, so each size is exactly that many chunks.
+    std::vector<size_t> radix_sizes;
+    for (size_t n = 8; n <= 512; n += 8) {
+        radix_sizes.push_back(n);
+    }
+    size_t to_string = crossover("to_string", BigInt::TO_STRING_DC_THRESHOLD, radix_sizes,
+        [&rng](size_t n) -> std::function<void()> {
+            BigInt a = random_limbs(n, rng);
+            return [a]() { a.to_dec(); };
+        }, 512);
+    size_t from_string = crossover("from_string", BigInt::FROM_STRING_DC_THRESHOLD, radix_sizes,
+        [&rng](size_t n) -> std::function<void()> {
+            std::string dec = random_limbs(n + 1, rng).to_dec().substr(0, 19 * n);
+            return [dec]() { BigInt::from_string(dec); };
+        }, 512);
+
+    // Serial vs. threaded Karatsuba, which needs more than one thread
+    size_t parallel = BigInt::PARALLEL_MUL_THRESHOLD;
+    if (BigInt::get_max_threads() > 1) {
+        std::vector<size_t> parallel_sizes;
+        for (size_t n = 512; n <= 32768; n *= 2) {
+            parallel_sizes.push_back(n);
+        }
+        parallel = crossover("parallel", BigInt::PARALLEL_MUL_THRESHOLD, parallel_sizes,
+            [&rng](size_t n) -> std::function<void()> {
+                BigInt a = random_limbs(n, rng), b = random_limbs(n, rng);
+                return [a, b]() { BigInt p = a * b; };
+            }, BigInt::PARALLEL_MUL_THRESHOLD);
+    } else {
+        std::cerr << "parallel: one hardware thread, keeping the default" << std::endl;
+    }
+
+    std::cout << "// Generated by bigint_tune (\"make tune\") for this machine; rerun it\n"
+              << "// rather than editing. See bigint.h for what each threshold means.\n"
+              << "#ifndef BIGINT_THRESHOLDS_H\n"
+              << "#define BIGINT_THRESHOLDS_H\n"
+              << "\n"
+              << "#define BIGINT_KARATSUBA_THRESHOLD " << karatsuba << "\n"
+              << "#define BIGINT_PARALLEL_MUL_THRESHOLD " << parallel << "\n"
+              << "#define BIGINT_TO_STRING_DC_THRESHOLD " << to_string << "\n"
+              << "#define BIGINT_FROM_STRING_DC_THRESHOLD " << from_string << "\n"
+              << "\n"
+              << "#endif // BIGINT_THRESHOLDS_H\n";
+    return 0;
+}